@@ -62,14 +62,14 @@ public:
     a_.relay(des, m);
   }
 
-  inline response_t request(aid_t recver, message const& m)
+  inline response_t request(aid_t recver, message const& m, duration_t tmo = infin)
   {
-    return a_.request(recver, m);
+    return a_.request(recver, m, tmo);
   }
 
-  inline response_t request(svcid_t recver, message const& m)
+  inline response_t request(svcid_t recver, message const& m, duration_t tmo = infin)
   {
-    return a_.request(recver, m);
+    return a_.request(recver, m, tmo);
   }
 
   inline void reply(aid_t recver, message const& m)
@@ -77,6 +77,33 @@ public:
     a_.reply(recver, m);
   }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  inline void send(aid_t recver, message&& m)
+  {
+    a_.send(recver, std::move(m));
+  }
+
+  inline void send(svcid_t recver, message&& m)
+  {
+    a_.send(recver, std::move(m));
+  }
+
+  inline void relay(aid_t des, message&& m)
+  {
+    a_.relay(des, std::move(m));
+  }
+
+  inline void relay(svcid_t des, message&& m)
+  {
+    a_.relay(des, std::move(m));
+  }
+
+  inline void reply(aid_t recver, message&& m)
+  {
+    a_.reply(recver, std::move(m));
+  }
+#endif
+
   inline void link(aid_t target)
   {
     a_.link(target);
@@ -100,11 +127,30 @@ public:
     return a_.recv(res, msg, tmo);
   }
 
+  inline std::size_t recv_batch(
+    msg_batch_t& batch, std::size_t max_n, match const& mach = match()
+    )
+  {
+    return a_.recv_batch(batch, max_n, mach);
+  }
+
+  inline std::size_t recv_responses(
+    response_list_t& pending, res_batch_t& batch, duration_t tmo, bool all
+    )
+  {
+    return a_.recv_responses(pending, batch, tmo, all);
+  }
+
   inline void wait(duration_t dur)
   {
     a_.wait(dur);
   }
 
+  inline void offload(offload_func_t const& f)
+  {
+    a_.offload(f);
+  }
+
   inline yield_t get_yield()
   {
     return a_.get_yield();
@@ -120,6 +166,16 @@ public:
     a_.chain(flag);
   }
 
+  inline void set_mailbox_limit(mailbox_limit const& limit)
+  {
+    a_.set_mailbox_limit(limit);
+  }
+
+  inline void discard(response_list_t const& pending)
+  {
+    a_.discard(pending);
+  }
+
 public:
   /// internal use
   inline sid_t spawn(
@@ -177,14 +233,14 @@ public:
     a_.relay(des, m);
   }
 
-  inline response_t request(aid_t recver, message const& m)
+  inline response_t request(aid_t recver, message const& m, duration_t tmo = infin)
   {
-    return a_.request(recver, m);
+    return a_.request(recver, m, tmo);
   }
 
-  inline response_t request(svcid_t recver, message const& m)
+  inline response_t request(svcid_t recver, message const& m, duration_t tmo = infin)
   {
-    return a_.request(recver, m);
+    return a_.request(recver, m, tmo);
   }
 
   inline void reply(aid_t recver, message const& m)
@@ -215,6 +271,20 @@ public:
     return a_.recv(res, msg, tmo);
   }
 
+  inline std::size_t recv_batch(
+    msg_batch_t& batch, std::size_t max_n, match const& mach = match()
+    )
+  {
+    return a_.recv_batch(batch, max_n, mach);
+  }
+
+  inline std::size_t recv_responses(
+    response_list_t& pending, res_batch_t& batch, duration_t tmo, bool all
+    )
+  {
+    return a_.recv_responses(pending, batch, tmo, all);
+  }
+
   inline void wait(duration_t dur)
   {
     a_.wait(dur);
@@ -230,6 +300,16 @@ public:
     a_.chain(flag);
   }
 
+  inline void set_mailbox_limit(mailbox_limit const& limit)
+  {
+    a_.set_mailbox_limit(limit);
+  }
+
+  inline void discard(response_list_t const& pending)
+  {
+    a_.discard(pending);
+  }
+
 public:
   /// internal use
   inline sid_t spawn(
@@ -297,14 +377,14 @@ public:
     a_.relay(des, m);
   }
 
-  inline response_t request(aid_t recver, message const& m)
+  inline response_t request(aid_t recver, message const& m, duration_t tmo = infin)
   {
-    return a_.request(recver, m);
+    return a_.request(recver, m, tmo);
   }
 
-  inline response_t request(svcid_t recver, message const& m)
+  inline response_t request(svcid_t recver, message const& m, duration_t tmo = infin)
   {
-    return a_.request(recver, m);
+    return a_.request(recver, m, tmo);
   }
 
   inline void reply(aid_t recver, message const& m)
@@ -312,6 +392,33 @@ public:
     a_.reply(recver, m);
   }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  inline void send(aid_t recver, message&& m)
+  {
+    a_.send(recver, std::move(m));
+  }
+
+  inline void send(svcid_t recver, message&& m)
+  {
+    a_.send(recver, std::move(m));
+  }
+
+  inline void relay(aid_t des, message&& m)
+  {
+    a_.relay(des, std::move(m));
+  }
+
+  inline void relay(svcid_t des, message&& m)
+  {
+    a_.relay(des, std::move(m));
+  }
+
+  inline void reply(aid_t recver, message&& m)
+  {
+    a_.reply(recver, std::move(m));
+  }
+#endif
+
   inline void link(aid_t target)
   {
     a_.link(target);
@@ -345,11 +452,30 @@ public:
     return a_.recv(res, msg);
   }
 
+  inline void recv_batch(
+    msg_batch_t& batch, std::size_t max_n, match const& mach = match()
+    )
+  {
+    a_.recv_batch(batch, max_n, mach);
+  }
+
+  inline void recv_responses(
+    response_list_t& pending, res_batch_t& batch, duration_t tmo, bool all
+    )
+  {
+    a_.recv_responses(pending, batch, tmo, all);
+  }
+
   inline void wait(duration_t dur)
   {
     a_.wait(dur);
   }
 
+  inline void offload(offload_func_t const& f)
+  {
+    a_.offload(f);
+  }
+
   inline aid_t get_aid() const
   {
     return a_.get_aid();
@@ -360,6 +486,16 @@ public:
     a_.chain(flag);
   }
 
+  inline void set_mailbox_limit(mailbox_limit const& limit)
+  {
+    a_.set_mailbox_limit(limit);
+  }
+
+  inline void discard(response_list_t const& pending)
+  {
+    a_.discard(pending);
+  }
+
 public:
   /// internal use
   inline void recv(recv_handler_t const& h, match const& mach = match())
@@ -375,11 +511,24 @@ public:
     a_.recv(h, res, tmo);
   }
 
+  inline void recv_batch(
+    wait_handler_t const& h, msg_batch_t& batch, 
+    std::size_t max_n, match const& mach = match()
+    )
+  {
+    a_.recv_batch(h, batch, max_n, mach);
+  }
+
   inline void wait(wait_handler_t const& h, duration_t dur)
   {
     a_.wait(h, dur);
   }
 
+  inline void offload(offload_func_t const& f, wait_handler_t const& h)
+  {
+    a_.offload(f, h);
+  }
+
   inline sid_t spawn(
     detail::spawn_type type, match_t func, 
     match_t ctxid, std::size_t stack_size
@@ -497,14 +646,14 @@ public:
     a_.relay(des, m);
   }
 
-  inline response_t request(aid_t recver, message const& m)
+  inline response_t request(aid_t recver, message const& m, duration_t tmo = infin)
   {
-    a_.request(recver, m);
+    return a_.request(recver, m, tmo);
   }
 
-  inline response_t request(svcid_t recver, message const& m)
+  inline response_t request(svcid_t recver, message const& m, duration_t tmo = infin)
   {
-    a_.request(recver, m);
+    return a_.request(recver, m, tmo);
   }
 
   inline void reply(aid_t recver, message const& m)
@@ -512,6 +661,33 @@ public:
     a_.reply(recver, m);
   }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  inline void send(aid_t recver, message&& m)
+  {
+    a_.send(recver, std::move(m));
+  }
+
+  inline void send(svcid_t recver, message&& m)
+  {
+    a_.send(recver, std::move(m));
+  }
+
+  inline void relay(aid_t des, message&& m)
+  {
+    a_.relay(des, std::move(m));
+  }
+
+  inline void relay(svcid_t des, message&& m)
+  {
+    a_.relay(des, std::move(m));
+  }
+
+  inline void reply(aid_t recver, message&& m)
+  {
+    a_.reply(recver, std::move(m));
+  }
+#endif
+
   inline void link(aid_t target)
   {
     a_.link(target);
@@ -527,11 +703,25 @@ public:
     return a_.recv(msg, match_list);
   }
 
+  /// Never waits, mach.timeout_ is ignored.
+  inline aid_t recv(message& msg, match const& mach)
+  {
+    return a_.recv(msg, mach);
+  }
+
   inline aid_t recv(response_t res, message& msg)
   {
     return a_.recv(res, msg);
   }
 
+  /// Never waits, mach.timeout_ is ignored.
+  inline std::size_t recv_batch(
+    msg_batch_t& batch, std::size_t max_n, match const& mach = match()
+    )
+  {
+    return a_.recv_batch(batch, max_n, mach);
+  }
+
   inline aid_t get_aid() const
   {
     return a_.get_aid();
@@ -13,12 +13,15 @@
 #include <gce/actor/context.hpp>
 #include <gce/actor/send.hpp>
 #include <gce/actor/recv.hpp>
+#include <gce/actor/gather.hpp>
 #include <gce/actor/wait.hpp>
+#include <gce/actor/offload.hpp>
 #include <gce/actor/actor.hpp>
 #include <gce/actor/message.hpp>
 #include <gce/actor/remote.hpp>
 #include <gce/actor/spawn.hpp>
 #include <gce/actor/match.hpp>
+#include <gce/actor/mailbox_limit.hpp>
 #include <gce/actor/service.hpp>
 #include <gce/actor/response.hpp>
 #include <gce/actor/actor_id.hpp>
@@ -13,13 +13,20 @@
 #include <gce/actor/config.hpp>
 #include <gce/actor/service_id.hpp>
 #include <gce/actor/response.hpp>
+#include <gce/actor/match.hpp>
+#include <gce/actor/mailbox_limit.hpp>
 #include <gce/actor/detail/mailbox.hpp>
+#include <gce/actor/detail/inbox.hpp>
 #include <gce/actor/detail/request.hpp>
 #include <gce/actor/detail/link.hpp>
 #include <gce/actor/actor_id.hpp>
 #include <boost/function.hpp>
+#include <boost/optional.hpp>
+#include <deque>
 #include <map>
 #include <set>
+#include <vector>
+#include <utility>
 
 namespace gce
 {
@@ -29,13 +36,27 @@ class context;
 namespace detail
 {
 class cache_pool;
+class watchdog;
 struct pack;
 }
 
+/// Blocking call run by offload() out of actor's strand.
+typedef boost::function<void ()> offload_func_t;
+
+/// Filled by recv_batch, in mailbox order.
+typedef std::vector<std::pair<aid_t, message> > msg_batch_t;
+
+/// Outstanding requests and their responses, see recv_responses.
+typedef std::vector<response_t> response_list_t;
+typedef std::vector<std::pair<response_t, message> > res_batch_t;
+
 class basic_actor
 {
 public:
-  basic_actor(context* ctx, detail::cache_pool*, std::size_t cache_queue_index);
+  basic_actor(
+    context* ctx, detail::cache_pool*,
+    std::size_t cache_queue_index, bool own_strand = false
+    );
   virtual ~basic_actor();
 
 public:
@@ -44,6 +65,13 @@ public:
   inline aid_t get_aid() const { return aid_; }
   inline void chain(bool flag) { chain_ = flag; }
 
+  /// Bound mb_; applied in snd_, so safe from any thread.
+  void set_mailbox_limit(mailbox_limit const&);
+
+  /// Give up on pending, their responses are freed or dropped on arrival;
+  /// applied in snd_ too.
+  void discard(response_list_t const& pending);
+
 public:
   /// internal use
   enum send_hint
@@ -57,10 +85,26 @@ public:
   void pri_relay(aid_t, message&, send_hint hint = sync);
   void pri_relay_svc(svcid_t, message&, send_hint hint = sync);
 
-  void pri_request(response_t, aid_t, message const&, send_hint hint = sync);
-  void pri_request_svc(response_t, svcid_t, message const&, send_hint hint = sync);
+  /// tmo: requester's wait, the recver drops the request after it.
+  void pri_request(
+    response_t, aid_t, message const&,
+    duration_t tmo = infin, send_hint hint = sync
+    );
+  void pri_request_svc(
+    response_t, svcid_t, message const&,
+    duration_t tmo = infin, send_hint hint = sync
+    );
   void pri_reply(aid_t, message const&, send_hint hint = sync);
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  /// Move m into the pack instead of copying it.
+  void pri_send(aid_t, message&&, send_hint hint = sync);
+  void pri_send_svc(svcid_t, message&&, send_hint hint = sync);
+  void pri_relay(aid_t, message&&, send_hint hint = sync);
+  void pri_relay_svc(svcid_t, message&&, send_hint hint = sync);
+  void pri_reply(aid_t, message&&, send_hint hint = sync);
+#endif
+
   void pri_link(aid_t, send_hint hint = sync);
   void pri_monitor(aid_t, send_hint hint = sync);
 
@@ -72,6 +116,9 @@ public:
 protected:
   virtual void on_recv(detail::pack&, send_hint hint) = 0;
 
+  /// Handle one pack drained from inbox_, in snd_.
+  virtual void handle_recv(detail::pack&) = 0;
+
 public:
   inline detail::cache_pool* get_cache_pool() { return user_; }
   void on_free();
@@ -88,10 +135,155 @@ protected:
   void send_already_exited(aid_t recver, response_t res);
   void send(aid_t const& recver, detail::pack&, send_hint);
 
+  /// If mach filters on a local service, copy it into tmp with from_ set to
+  /// the service's current actor and return tmp; else return mach.
+  match const& filter_match(match const& mach, match& tmp);
+
+  /// mb_.pop, then resume a blocked inbox and re-arm the overload alarm
+  /// if it made room.
+  bool pop_msg(detail::recv_t&, message&, match const&);
+  bool pop_msg(detail::recv_t&, message&, match_list_t const&);
+
+  /// Append up to max_n msgs matching mach already in mb_; never waits.
+  std::size_t pop_batch(msg_batch_t&, std::size_t max_n, match const&);
+
+  /// Sender of a popped msg; also set msg.req_ if it is a request.
+  static aid_t get_sender(detail::recv_t&, message&);
+
+  /// Move every answered one of pending (response or recver's exit) to
+  /// batch, keep the order of the rest; return number moved.
+  std::size_t pop_responses(response_list_t& pending, res_batch_t&);
+
+  /// State of a recv_responses waiting in snd_; owner collects answers on
+  /// each response or exit pack, and is woken once, after the drain.
+  /// Unanswered ids are indexed, so a response pack costs one lookup;
+  /// *pending_ is only compacted by finish().
+  struct res_gather
+  {
+    res_gather()
+      : pending_(0)
+      , batch_(0)
+      , all_(false)
+      , got_(0)
+      , woken_(false)
+    {
+    }
+
+    void start(response_list_t& pending, res_batch_t& batch, bool all)
+    {
+      pending_ = &pending;
+      batch_ = &batch;
+      all_ = all;
+      got_ = 0;
+      woken_ = false;
+      id_list_.reserve(pending.size());
+      for (std::size_t i=0; i<pending.size(); ++i)
+      {
+        id_list_[pending[i].get_id()] = true;
+      }
+    }
+
+    bool waiting() const { return pending_ != 0; }
+
+    /// Add n collected, return true only the first time owner should wake.
+    bool ready(std::size_t n)
+    {
+      got_ += n;
+      if (woken_)
+      {
+        return false;
+      }
+      woken_ = id_list_.empty() || (!all_ && got_ > 0);
+      return woken_;
+    }
+
+    /// Drop answered ones from *pending_, keep the order of the rest.
+    void finish()
+    {
+      if (pending_)
+      {
+        std::size_t last = 0;
+        for (std::size_t i=0; i<pending_->size(); ++i)
+        {
+          if (id_list_.find((*pending_)[i].get_id()))
+          {
+            (*pending_)[last++] = (*pending_)[i];
+          }
+        }
+        pending_->resize(last);
+      }
+      clear();
+    }
+
+    void clear()
+    {
+      pending_ = 0;
+      batch_ = 0;
+      all_ = false;
+      got_ = 0;
+      woken_ = false;
+      id_list_.clear();
+    }
+
+    response_list_t* pending_;
+    res_batch_t* batch_;
+    bool all_;
+    std::size_t got_;
+    bool woken_;
+    detail::flat_table<sid_t, bool, detail::sid_hash> id_list_;
+  };
+
+  /// On a response pack: move res's answer to gather's batch if res is
+  /// one it waits for; return number moved.
+  std::size_t pop_response(res_gather&, response_t const& res);
+
+  /// On an exit pack: move every answered one gather waits for to its
+  /// batch; return number moved.
+  std::size_t pop_responses(res_gather&);
+
+  /// Queue pack into inbox_, wake up snd_ only if this actor is idle;
+  /// pack is moved from.
+  void push_inbox(detail::pack&, send_hint);
+
+  /// Run budget of one activation (msg_budget_/time_budget_): count one
+  /// msg, return true if the actor should give up its strand now. Msgs are
+  /// counted as they drain from inbox_, unless count_on_pop() was called;
+  /// then the actor counts them itself, as its recv pops them.
+  void begin_activation();
+  bool consume_budget();
+  void end_activation();
+  inline void count_on_pop() { count_on_pop_ = true; }
+
 private:
+  void handle_inbox();
+  void handle_pack(detail::pack&);
+  void handle_parked();
+  bool stop_drain();
+  void post_inbox();
+  strand_t& select_strand(bool own_strand);
   aid_t filter_aid(aid_t const& src);
   aid_t filter_svcid(svcid_t const& src);
 
+  /// Address pk, whose msg_ is set, and send it.
+  void route(aid_t recver, detail::pack& pk, send_hint);
+  void route_svc(svcid_t recver, detail::pack& pk, send_hint);
+  void route_relay(aid_t recver, detail::pack& pk, detail::request_t, send_hint);
+  void route_relay_svc(svcid_t recver, detail::pack& pk, detail::request_t, send_hint);
+  void route_reply(aid_t recver, detail::pack& pk, send_hint);
+
+  /// mailbox limit
+  void pri_set_mailbox_limit(mailbox_limit);
+  void pri_discard(response_list_t);
+  void on_pop();
+  void unpark();
+  void park(detail::pack&);
+  bool bounded(detail::pack const&) const;
+  static detail::recv_t get_recv(detail::pack const&);
+  bool admit(detail::pack&);
+  void drop(detail::recv_t const&, message const&, bool notify_sender);
+  void check_high_water();
+  void send_exit_ret(aid_t recver, response_t, exit_code_t, std::string const&);
+
 private:
   /// Ensure start from a new cache line.
   byte_t pad0_[GCE_CACHE_LINE_SIZE];
@@ -99,15 +291,41 @@ private:
 protected:
   GCE_CACHE_ALIGNED_VAR(context*, ctx_)
   GCE_CACHE_ALIGNED_VAR(detail::cache_pool*, user_)
+
+private:
+  /// Only used in sched_actor mode, must be constructed before snd_.
+  GCE_CACHE_ALIGNED_VAR(boost::optional<strand_t>, own_snd_)
+
+protected:
   GCE_CACHE_ALIGNED_VAR(strand_t&, snd_)
   GCE_CACHE_ALIGNED_VAR(detail::mailbox, mb_)
   GCE_CACHE_ALIGNED_VAR(ctxid_t const, ctxid_)
   GCE_CACHE_ALIGNED_VAR(timestamp_t const, timestamp_)
   GCE_CACHE_ALIGNED_VAR(std::size_t const, cache_queue_index_)
+  GCE_CACHE_ALIGNED_VAR(detail::watchdog* const, wdg_)
 
 private:
   GCE_CACHE_ALIGNED_VAR(aid_t, aid_)
   GCE_CACHE_ALIGNED_VAR(bool, chain_)
+  detail::inbox inbox_;
+
+  /// activation budget
+  typedef boost::chrono::steady_clock::time_point time_point_t;
+  std::size_t const msg_budget_;
+  duration_t const time_budget_;
+  bool const track_fairness_;
+  std::size_t run_num_;
+  time_point_t run_begin_;
+  bool preempted_;
+  bool running_;
+  bool count_on_pop_;
+
+  /// mailbox limit; parked_list_ holds the user packs overflow_block held
+  /// back, in arrival order, while the inbox keeps draining the rest.
+  mailbox_limit mb_limit_;
+  std::deque<detail::pack> parked_list_;
+  bool unpark_posted_;
+  bool overloaded_;
 
   /// local vals
   sid_t req_id_;
@@ -22,6 +22,7 @@
 #include <boost/atomic.hpp>
 
 #include <gce/amsg/amsg.hpp>
+#include <gce/detail/inline_list.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/chrono.hpp>
 #include <boost/asio/coroutine.hpp>
@@ -52,7 +53,10 @@ static boost::uint32_t const sid_nil = static_cast<sid_t>(-1);
 
 typedef boost::uint64_t match_t;
 static boost::uint64_t const match_nil = static_cast<boost::uint64_t>(-1);
-typedef std::vector<match_t> match_list_t;
+
+/// Inline up to GCE_MATCH_INLINE_SIZE types (exit included), so a selective
+/// recv doesn't allocate.
+typedef detail::inline_list<match_t, GCE_MATCH_INLINE_SIZE> match_list_t;
 
 typedef match_t ctxid_t;
 static match_t const ctxid_nil = static_cast<boost::uint64_t>(-1);
@@ -79,6 +83,8 @@ static exit_code_t const exit_except = atom("gce_ex_except");
 static exit_code_t const exit_remote = atom("gce_ex_remote");
 static exit_code_t const exit_already = atom("gce_ex_already");
 static exit_code_t const exit_neterr = atom("gce_ex_neterr");
+/// Only atoms of up to 13 chars decode back, so "gce_ex_overflow" won't do.
+static exit_code_t const exit_overflow = atom("gce_ex_ovflow");
 
 namespace detail
 {
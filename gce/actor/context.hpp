@@ -12,10 +12,14 @@
 
 #include <gce/actor/config.hpp>
 #include <gce/actor/actor_id.hpp>
+#include <gce/actor/detail/watchdog.hpp>
+#include <gce/actor/detail/match_index.hpp>
 #include <gce/detail/unique_ptr.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/atomic.hpp>
 #include <boost/optional.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/container/vector.hpp>
 #include <boost/lockfree/queue.hpp>
 #include <vector>
@@ -24,6 +28,69 @@ namespace gce
 {
 typedef std::size_t thrid_t;
 typedef boost::function<void (thrid_t)> thread_callback_t;
+
+/// How actors are scheduled on the context's threads.
+enum sched_mode
+{
+  /// All actors of a cache_pool share the pool's strand.
+  sched_cache_pool = 0,
+
+  /// Every stackful/stackless actor, socket and acceptor runs on its own
+  /// strand; all threads drain the same run queue, so a busy actor only
+  /// serializes itself instead of its whole cache_pool.
+  sched_actor,
+};
+
+/// How spawn picks a cache_pool for a new actor. Placement is only done
+/// at spawn: a running actor is never moved to another cache_pool, neither
+/// when its pool gets busy nor to join the actors it talks to most.
+enum placement_policy
+{
+  /// Plain round-robin.
+  place_round_robin = 0,
+
+  /// Least loaded of the spawner's pool and two round-robin candidates
+  /// (live actors plus activations queued); ties keep the spawner's pool,
+  /// so parent and child, which usually talk a lot, stay together.
+  place_least_loaded,
+};
+
+/// Where cache_pools and the actors they spawn are placed.
+enum numa_policy
+{
+  /// No placement, pools are picked round-robin.
+  numa_none = 0,
+
+  /// Every pool is built by (so first-touched on) the thread that runs it,
+  /// and actors spawned from a pool stay on pools of the same NUMA node;
+  /// needs cpu_list_ and thread_num_ > 0.
+  numa_local,
+};
+
+/// A named execution pool, see attributes::pool_list_.
+struct pool_attributes
+{
+  explicit pool_attributes(match_t name = match_nil, std::size_t thread_num = 1)
+    : name_(name)
+    , thread_num_(thread_num)
+  {
+  }
+
+  match_t name_;
+  std::size_t thread_num_;
+};
+
+/// Target named pool of spawn, e.g. spawn(self, f, pool_name(atom("cpu"))).
+struct pool_name
+{
+  explicit pool_name(match_t name)
+    : name_(name)
+  {
+  }
+
+  match_t name_;
+};
+
 struct attributes
 {
   attributes()
@@ -36,6 +103,20 @@ struct attributes
     , socket_pool_reserve_size_(8)
     , acceptor_pool_reserve_size_(8)
     , max_cache_match_size_(32)
+    , match_index_size_(1024)
+    , sched_mode_(sched_cache_pool)
+    , per_thread_io_service_(false)
+    , numa_policy_(numa_none)
+    , placement_(place_round_robin)
+    , max_thread_num_(0)
+    , elastic_period_(boost::chrono::milliseconds(100))
+    , msg_budget_(0)
+    , time_budget_(zero)
+    , track_fairness_(false)
+    , blocking_thread_num_(4)
+    , stall_threshold_(zero)
+    , spin_period_(zero)
+    , io_pool_(match_nil)
   {
   }
 
@@ -47,11 +128,101 @@ struct attributes
   std::size_t actor_pool_reserve_size_;
   std::size_t socket_pool_reserve_size_;
   std::size_t acceptor_pool_reserve_size_;
+
+  /// Match queues every mailbox makes up front; msg types are mapped to
+  /// dense ids (see match_index_size_), so the most used ones are covered.
   std::size_t max_cache_match_size_;
+
+  /// Max distinct msg types given own dense ids; types met after that, or
+  /// finding no free slot near their hash, share one match queue, which is
+  /// then searched.
+  std::size_t match_index_size_;
+  sched_mode sched_mode_;
+
+  /// Give every thread its own io_service (ignored if ios_ set); cache_pools
+  /// and their actors, sockets and timers are pinned to one of them.
+  bool per_thread_io_service_;
+
+  /// Thread i is pinned to cpu_list_[i % size]; empty means threads float.
+  std::vector<std::size_t> cpu_list_;
+  numa_policy numa_policy_;
+
+  /// Spawn time only, see placement_policy; there is no live rebalancer.
+  placement_policy placement_;
+
+  /// If > thread_num_, up to (max_thread_num_ - thread_num_) extra threads
+  /// are started while handlers wait longer than elastic_period_/10 in the
+  /// run queue, and retired one by one after 10 quiet periods; only with a
+  /// shared io_service (not per_thread_io_service_).
+  std::size_t max_thread_num_;
+  duration_t elastic_period_;
+
+  /// Max msgs (0 for no limit) and time (zero for no limit) a stackful or
+  /// stackless actor may handle in one go; then it is put back at the end
+  /// of its strand's queue.
+  std::size_t msg_budget_;
+  duration_t time_budget_;
+
+  /// Collect fairness_stat of every cache_pool.
+  bool track_fairness_;
+
+  /// Threads running offload()ed blocking calls, started on first use.
+  /// Only the threads are bounded; calls beyond them queue up.
+  /// On stop, queued calls fail, running ones are waited for: a blocking
+  /// call that never returns hangs the context's destruction.
+  std::size_t blocking_thread_num_;
+
+  /// If > zero, a watchdog thread reports actor activations (inbox msgs,
+  /// stackful resumes, stackless runs) longer than it to stall_cb_
+  /// (std::cerr if empty).
+  duration_t stall_threshold_;
+  stall_callback_t stall_cb_;
+
+  /// Latency mode: if > zero, an idle thread keeps polling its io_service
+  /// this long before it parks, so handoffs under load need no futex wake,
+  /// and a burst of posts finds threads already awake.
+  duration_t spin_period_;
+
+  /// Named pools, each with its own io_service, thread_num_ threads and
+  /// (thread_num_ * per_thread_cache_pool_num_) cache_pools; only actors
+  /// spawned with pool_name, and sockets and acceptors, run there, e.g. to
+  /// keep network latency away from CPU-heavy actors. Actors they spawn
+  /// without pool_name go back to the default pools.
+  std::vector<pool_attributes> pool_list_;
+
+  /// Named pool sockets and acceptors run on unless net_option::pool_ says
+  /// otherwise; made with one thread if not in pool_list_; match_nil for
+  /// the default pools.
+  match_t io_pool_;
   std::vector<thread_callback_t> thread_begin_cb_list_;
   std::vector<thread_callback_t> thread_end_cb_list_;
 };
 
+/// Per cache_pool activation counters, see context::get_fairness_stat.
+struct fairness_stat
+{
+  fairness_stat()
+    : activation_num_(0)
+    , preempt_num_(0)
+    , max_activation_(zero)
+    , shed_num_(0)
+  {
+  }
+
+  /// Times actors got to run their msgs.
+  std::size_t activation_num_;
+
+  /// Activations cut short by msg_budget_/time_budget_.
+  std::size_t preempt_num_;
+
+  /// Longest activation seen.
+  duration_t max_activation_;
+
+  /// Requests dropped unprocessed since their deadline passed; counted
+  /// whether or not track_fairness_ is on.
+  std::size_t shed_num_;
+};
+
 namespace detail
 {
 class cache_pool;
@@ -80,8 +251,41 @@ public:
 
   thread_mapped_actor& make_thread_mapped_actor();
   detail::cache_pool* select_cache_pool();
+
+  /// Prefer pools on the same NUMA node as near (numa_local only), and
+  /// near itself if it is not busier than others (place_least_loaded only).
+  detail::cache_pool* select_cache_pool(detail::cache_pool* near);
+
+  /// Round-robin in the given named pool; match_nil for default pools.
+  detail::cache_pool* select_cache_pool(pool_name);
+
+  /// For a socket or acceptor: the given pool (net_option::pool_), else
+  /// io_pool_, else like select_cache_pool(near).
+  detail::cache_pool* select_net_cache_pool(match_t pool, detail::cache_pool* near);
   nonblocking_actor& make_nonblocking_actor();
 
+  /// One per cache_pool, all zero unless track_fairness_ set.
+  std::vector<fairness_stat> get_fairness_stat();
+
+  /// Run f on a blocking thread, starting them if not yet; any thread.
+  /// Throws once the context is stopping, f would never run.
+  void post_blocking(boost::function<void ()> const& f);
+
+  /// Throws like post_blocking once the context is stopping; a queued
+  /// blocking job calls it first, to fail instead of running.
+  void check_blocking();
+
+  inline detail::match_index& get_match_index() { return match_index_; }
+
+  /// numa_local only: default pool indexes of each NUMA node, else empty.
+  inline std::vector<std::vector<std::size_t> > const& get_node_pool_list() const
+  {
+    return node_pool_list_;
+  }
+
+  /// Null if stall_threshold_ is zero.
+  inline detail::watchdog* get_watchdog() { return watchdog_.get(); }
+
   void register_service(match_t name, aid_t svc, std::size_t cache_queue_index);
   void deregister_service(match_t name, aid_t svc, std::size_t cache_queue_index);
 
@@ -89,12 +293,57 @@ public:
   void deregister_socket(ctxid_pair_t ctxid_pr, aid_t skt, std::size_t cache_queue_index);
 
 private:
+  struct named_pool
+  {
+    match_t name_;
+
+    /// First index in cache_pool_list_.
+    std::size_t begin_;
+    std::size_t size_;
+  };
+
+  static attributes make_attributes(attributes);
+  void make_named_pools();
   void run(
-    thrid_t,
+    thrid_t, io_service_t*,
     std::vector<thread_callback_t> const&,
     std::vector<thread_callback_t> const&
     );
   void stop();
+  void stop_cache_pool(detail::cache_pool*);
+  /// Spins first if spin_period_ set; an elastic thread also returns once
+  /// it claims a retirement (try_retire) after a handler.
+  void run_io_service(io_service_t&, bool elastic = false);
+  bool try_retire();
+  void make_cache_pool(std::size_t index);
+  void make_local_cache_pools(thrid_t);
+  detail::cache_pool* select_least_loaded(detail::cache_pool*, detail::cache_pool*);
+
+  /// A fixed elastic thread slot; its thread is joined before reuse.
+  struct elastic_slot
+  {
+    elastic_slot()
+      : id_(0)
+      , free_(true)
+    {
+    }
+
+    boost::thread thr_;
+    thrid_t id_;
+    boost::atomic_bool free_;
+  };
+
+  void run_elastic(
+    elastic_slot&,
+    std::vector<thread_callback_t> const&,
+    std::vector<thread_callback_t> const&
+    );
+  void start_elastic_timer();
+  void handle_elastic_timeout(errcode_t const&);
+  void handle_probe(boost::chrono::steady_clock::time_point);
+  void wake_up();
+  void run_blocking();
+  void stop_elastic();
 
 private:
   /// Ensure start from a new cache line.
@@ -102,17 +351,64 @@ private:
 
   GCE_CACHE_ALIGNED_VAR(attributes, attrs_)
   GCE_CACHE_ALIGNED_VAR(timestamp_t const, timestamp_)
+  GCE_CACHE_ALIGNED_VAR(detail::match_index, match_index_)
 
   /// select cache pool
-  GCE_CACHE_ALIGNED_VAR(std::size_t, curr_cache_pool_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, curr_cache_pool_)
+  GCE_CACHE_ALIGNED_VAR(std::size_t, default_pool_size_)
+
+  /// default pools first, then named pools' ones
   GCE_CACHE_ALIGNED_VAR(std::size_t, cache_pool_size_)
   GCE_CACHE_ALIGNED_VAR(std::size_t, cache_queue_size_)
 
   GCE_CACHE_ALIGNED_VAR(detail::unique_ptr<io_service_t>, ios_)
-  GCE_CACHE_ALIGNED_VAR(boost::optional<io_service_t::work>, work_)
+
+  /// ios_ first, then the others in per_thread_io_service_ mode
+  GCE_CACHE_ALIGNED_VAR(std::vector<io_service_t*>, ios_list_)
+  GCE_CACHE_ALIGNED_VAR(std::vector<io_service_t::work>, work_list_)
 
   GCE_CACHE_ALIGNED_VAR(boost::thread_group, thread_group_)
+
+  /// cache_pools whose stop has not run yet; work_list_ is kept till 0
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, stopping_pool_num_)
+
+  GCE_CACHE_ALIGNED_VAR(detail::unique_ptr<detail::watchdog>, watchdog_)
+
+  /// offload()ed blocking calls
+  GCE_CACHE_ALIGNED_VAR(boost::mutex, blocking_mtx_)
+  GCE_CACHE_ALIGNED_VAR(detail::unique_ptr<io_service_t>, blocking_ios_)
+  GCE_CACHE_ALIGNED_VAR(boost::optional<io_service_t::work>, blocking_work_)
+  GCE_CACHE_ALIGNED_VAR(boost::thread_group, blocking_thread_group_)
+  bool blocking_stopped_;
+
+  /// elastic threads, elastic_snd_ guards timer and thread creation
+  GCE_CACHE_ALIGNED_VAR(boost::optional<strand_t>, elastic_snd_)
+  GCE_CACHE_ALIGNED_VAR(detail::unique_ptr<timer_t>, elastic_tmr_)
+  /// max_thread_num_ - thread_num_ slots, each keeps its thread id
+  GCE_CACHE_ALIGNED_VAR(boost::scoped_array<elastic_slot>, elastic_slot_list_)
+  GCE_CACHE_ALIGNED_VAR(std::size_t, elastic_slot_num_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, elastic_thread_num_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, retire_num_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_bool, probe_pending_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_bool, probe_slow_)
+
+  /// id of next named pool or elastic thread
+  thrid_t next_thread_id_;
+  std::size_t quiet_period_num_;
+  bool elastic_stopped_;
   GCE_CACHE_ALIGNED_VAR(std::vector<detail::cache_pool*>, cache_pool_list_)
+
+  /// numa_local mode: node of each pool, and pool indexes (with a
+  /// round-robin cursor) of each node
+  GCE_CACHE_ALIGNED_VAR(std::vector<std::size_t>, pool_node_list_)
+  GCE_CACHE_ALIGNED_VAR(std::vector<std::vector<std::size_t> >, node_pool_list_)
+  GCE_CACHE_ALIGNED_VAR(boost::scoped_array<boost::atomic_size_t>, curr_node_pool_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, ready_thread_num_)
+
+  /// named pools, with their io_services and round-robin cursors
+  GCE_CACHE_ALIGNED_VAR(std::vector<named_pool>, named_pool_list_)
+  GCE_CACHE_ALIGNED_VAR(std::vector<io_service_t*>, named_ios_list_)
+  GCE_CACHE_ALIGNED_VAR(boost::scoped_array<boost::atomic_size_t>, curr_named_pool_)
   
   GCE_CACHE_ALIGNED_VAR(std::vector<nonblocking_actor*>, nonblocking_actor_list_)
   GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, curr_nonblocking_actor_)
@@ -69,17 +69,17 @@ public:
     base_type::pri_relay_svc(des, m);
   }
 
-  inline response_t request(aid_t recver, message const& m)
+  inline response_t request(aid_t recver, message const& m, duration_t tmo = infin)
   {
     response_t res(base_type::new_request(), get_aid(), recver);
-    base_type::pri_request(res, recver, m);
+    base_type::pri_request(res, recver, m, tmo);
     return res;
   }
 
-  inline response_t request(svcid_t recver, message const& m)
+  inline response_t request(svcid_t recver, message const& m, duration_t tmo = infin)
   {
     response_t res(base_type::new_request(), get_aid(), recver);
-    base_type::pri_request_svc(res, recver, m);
+    base_type::pri_request_svc(res, recver, m, tmo);
     return res;
   }
 
@@ -88,6 +88,33 @@ public:
     base_type::pri_reply(recver, m);
   }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  inline void send(aid_t recver, message&& m)
+  {
+    base_type::pri_send(recver, std::move(m));
+  }
+
+  inline void send(svcid_t recver, message&& m)
+  {
+    base_type::pri_send_svc(recver, std::move(m));
+  }
+
+  inline void relay(aid_t des, message&& m)
+  {
+    base_type::pri_relay(des, std::move(m));
+  }
+
+  inline void relay(svcid_t des, message&& m)
+  {
+    base_type::pri_relay_svc(des, std::move(m));
+  }
+
+  inline void reply(aid_t recver, message&& m)
+  {
+    base_type::pri_reply(recver, std::move(m));
+  }
+#endif
+
   inline void link(aid_t target)
   {
     base_type::pri_link(target);
@@ -111,8 +138,22 @@ public:
     response_t, message&, 
     duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
     );
+
+  /// Append up to max_n matching msgs to batch; suspend only if there is
+  /// none yet. Return number appended, 0 if timed out.
+  std::size_t recv_batch(msg_batch_t& batch, std::size_t max_n, match const& mach = match());
+
+  /// Move answered ones of pending to batch; suspend until all (or, if not
+  /// all, any) answered or tmo passed. Return number moved.
+  std::size_t recv_responses(
+    response_list_t& pending, res_batch_t& batch, duration_t tmo, bool all
+    );
   void wait(duration_t);
 
+  /// Run f on context's blocking threads, resume when it returns; rethrow
+  /// its exception as std::runtime_error.
+  void offload(offload_func_t const& f);
+
   yield_t get_yield();
 
 public:
@@ -131,8 +172,13 @@ public:
 
 private:
   void run(yield_t);
-  void resume(actor_code ac = actor_normal);
+
+  /// drained: called by handle_recv, in handle_inbox's activation; else
+  /// (start, timer, post) it is an activation of its own.
+  void resume(actor_code ac = actor_normal, bool drained = false);
   actor_code yield();
+  void yield_budget();
+  void run_offload(offload_func_t const&, boost::optional<std::string>&);
   void free_self();
   void stop(exit_code_t, std::string);
   void start_recv_timer(duration_t);
@@ -155,6 +201,7 @@ private:
   response_t recving_res_;
   message recving_msg_;
   match curr_match_;
+  base_type::res_gather res_gather_;
   timer_t tmr_;
   std::size_t tmr_sid_;
   yield_t* yld_;
@@ -65,17 +65,17 @@ public:
     base_type::pri_relay_svc(des, m);
   }
 
-  inline response_t request(aid_t recver, message const& m)
+  inline response_t request(aid_t recver, message const& m, duration_t tmo = infin)
   {
     response_t res(new_request(), get_aid(), recver);
-    base_type::pri_request(res, recver, m);
+    base_type::pri_request(res, recver, m, tmo);
     return res;
   }
 
-  inline response_t request(svcid_t recver, message const& m)
+  inline response_t request(svcid_t recver, message const& m, duration_t tmo = infin)
   {
     response_t res(new_request(), get_aid(), recver);
-    base_type::pri_request_svc(res, recver, m);
+    base_type::pri_request_svc(res, recver, m, tmo);
     return res;
   }
 
@@ -84,6 +84,33 @@ public:
     base_type::pri_reply(recver, m);
   }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  inline void send(aid_t recver, message&& m)
+  {
+    base_type::pri_send(recver, std::move(m));
+  }
+
+  inline void send(svcid_t recver, message&& m)
+  {
+    base_type::pri_send_svc(recver, std::move(m));
+  }
+
+  inline void relay(aid_t des, message&& m)
+  {
+    base_type::pri_relay(des, std::move(m));
+  }
+
+  inline void relay(svcid_t des, message&& m)
+  {
+    base_type::pri_relay_svc(des, std::move(m));
+  }
+
+  inline void reply(aid_t recver, message&& m)
+  {
+    base_type::pri_reply(recver, std::move(m));
+  }
+#endif
+
   inline void link(aid_t target)
   {
     base_type::pri_link(target);
@@ -112,8 +139,22 @@ public:
     );
   aid_t recv(response_t res, message& msg);
 
+  /// Append up to max_n matching msgs to batch, resume when at least one
+  /// is in it or timed out (then batch is unchanged).
+  void recv_batch(msg_batch_t& batch, std::size_t max_n, match const& mach = match());
+
+  /// Move answered ones of pending to batch; resume when all (or, if not
+  /// all, any) answered or tmo passed.
+  void recv_responses(
+    response_list_t& pending, res_batch_t& batch, duration_t tmo, bool all
+    );
+
   void wait(duration_t);
 
+  /// Run f on context's blocking threads, resume when it returns; its
+  /// exception quits this actor with exit_except.
+  void offload(offload_func_t const& f);
+
 public:
   /// internal use
   void recv(recv_handler_t const&, match const& mach = match());
@@ -122,7 +163,12 @@ public:
     duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
     );
 
+  void recv_batch(
+    wait_handler_t const&, msg_batch_t& batch, 
+    std::size_t max_n, match const& mach = match()
+    );
   void wait(wait_handler_t const&, duration_t);
+  void offload(offload_func_t const&, wait_handler_t const&);
   void quit(exit_code_t exc = exit_normal, std::string const& errmsg = std::string());
 
 public:
@@ -151,15 +197,24 @@ private:
   void start_recv_timer(duration_t, recv_handler_t const&);
   void start_res_timer(duration_t, recv_handler_t const&);
   void start_wait_timer(duration_t, wait_handler_t const&);
+  void start_responses_timer(duration_t);
   void handle_recv_timeout(errcode_t const&, std::size_t, recv_handler_t const&);
   void handle_res_timeout(errcode_t const&, std::size_t, recv_handler_t const&);
   void handle_wait_timeout(errcode_t const&, std::size_t, wait_handler_t const&);
+  void handle_responses_timeout(errcode_t const&, std::size_t);
+  void end_recv_responses();
   void handle_recv(detail::pack&);
+  void run_offload(offload_func_t const&, wait_handler_t const&);
+  void handle_offload(boost::optional<std::string> const&, wait_handler_t const&);
 
   aid_t end_recv(detail::recv_t&, message&);
   aid_t end_recv(response_t&);
 
   void recv_handler(self_ref_t, aid_t, message, aid_t&, message&);
+  void batch_handler(
+    self_ref_t, aid_t, message, msg_batch_t&, 
+    std::size_t, match const&, wait_handler_t const&
+    );
   void wait_handler(self_ref_t);
 
 private:
@@ -176,6 +231,7 @@ private:
   wait_handler_t wait_h_;
   response_t recving_res_;
   match curr_match_;
+  base_type::res_gather res_gather_;
   timer_t tmr_;
   std::size_t tmr_sid_;
 };
@@ -0,0 +1,27 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_DETAIL_AFFINITY_HPP
+#define GCE_ACTOR_DETAIL_AFFINITY_HPP
+
+#include <gce/actor/config.hpp>
+
+namespace gce
+{
+namespace detail
+{
+/// Pin the calling thread to the given cpu; return false if unsupported.
+bool set_thread_affinity(std::size_t cpu);
+
+/// NUMA node of the given cpu, 0 if unknown.
+std::size_t get_cpu_node(std::size_t cpu);
+}
+}
+
+#endif /// GCE_ACTOR_DETAIL_AFFINITY_HPP
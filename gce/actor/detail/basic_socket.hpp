@@ -11,13 +11,13 @@
 #define GCE_ACTOR_DETAIL_BASIC_SOCKET_HPP
 
 #include <gce/actor/config.hpp>
+#include <gce/actor/net_option.hpp>
 #include <boost/shared_ptr.hpp>
 
 namespace gce
 {
 namespace detail
 {
-class cache_pool;
 class basic_socket
 {
 public:
@@ -25,8 +25,13 @@ public:
   virtual ~basic_socket() {}
 
 public:
-  virtual void init(cache_pool*) = 0;
-  virtual void send(byte_t const*, std::size_t, byte_t const*, std::size_t) = 0;
+  virtual void init(strand_t&, net_option const&) = 0;
+  /// Urgent ones go out before those not yet being written; order is kept
+  /// among urgent ones and among the rest, not across them.
+  virtual void send(
+    byte_t const*, std::size_t, byte_t const*, std::size_t,
+    bool urgent = false
+    ) = 0;
   virtual std::size_t recv(byte_t*, std::size_t, yield_t) = 0;
   virtual void connect(yield_t) = 0;
   virtual void close() = 0;
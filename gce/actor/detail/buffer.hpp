@@ -1,84 +1,228 @@
-﻿///
-/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
-///
-/// Distributed under the Boost Software License, Version 1.0. (See accompanying
-/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
-///
-/// See https://github.com/nousxiong/gce for latest version.
-///
-
-#ifndef GCE_ACTOR_DETAIL_BUFFER_HPP
-#define GCE_ACTOR_DETAIL_BUFFER_HPP
-
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_DETAIL_BUFFER_HPP
+#define GCE_ACTOR_DETAIL_BUFFER_HPP
+
 #include <gce/actor/config.hpp>
-#include <gce/detail/ref_count.hpp>
-#include <boost/bind.hpp>
+#include <gce/actor/detail/buffer_pool.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/cstdint.hpp>
 #include <new>
-#include <cstdlib>
 
 namespace gce
 {
 namespace detail
 {
+class buffer;
+typedef boost::intrusive_ptr<buffer> buffer_ptr;
+
+/// Ref-counted large msg buffer; this header and its payload share one
+/// buffer_pool block, which is given back when the last ref goes.
+///
+/// Counts are biased to the thread that made the buffer (its block's pool
+/// owner): its copies and drops touch biased_ only, with plain loads and
+/// stores and no atomic read-modify-write; other threads count in shared_.
+/// The owner merges biased_ into shared_ when biased_ drops to 0, or when
+/// another thread's drop takes shared_ below 0 and posts the buffer back to
+/// it. A buffer that bypassed the pool, or was made on a thread not biased
+/// (see buffer_pool::bias), is merged from the start.
 class buffer
-  : public ref_count
+  : private boost::noncopyable
 {
+  /// shared_ keeps its count above two flag bits.
+  enum
+  {
+    merged = 1,
+    queued = 2,
+    shared_one = 4
+  };
+
+  /// biased_ keeps its count in the low half and, above it, how many times
+  /// the owner wrote it, so other threads can tell it did not move.
+  static boost::uint64_t biased_write() { return (boost::uint64_t)1 << 32; }
+  static long biased_count(boost::uint64_t v) { return (long)(v & 0xffffffff); }
+
+  buffer(std::size_t size, void const* owner)
+    : owner_(owner)
+    , biased_(0)
+    , shared_(owner ? 0 : merged)
+    , size_(size)
+  {
+  }
+
 public:
-  buffer()
-    : ref_count(boost::bind(&buffer::free, this))
-    , data_(0)
-    , size_(0)
+  /// Payload capacity is at least size, rounded up to fill the block.
+  static buffer_ptr make(std::size_t size)
   {
+    std::size_t cap = header_size() + size;
+    byte_t* p = buffer_pool::allocate(cap);
+    void const* owner =
+      buffer_pool::get_owner(p) ? buffer_pool::current_owner() : 0;
+    return buffer_ptr(new (p) buffer(cap - header_size(), owner));
   }
 
-  explicit buffer(std::size_t size)
-    : ref_count(boost::bind(&buffer::free, this))
-    , data_((byte_t*)std::malloc(size))
-    , size_(size)
+public:
+  inline byte_t* data() { return (byte_t*)this + header_size(); }
+  inline std::size_t size() const { return size_; }
+
+  /// Exact on any thread: off the owner, shared_ is read between two
+  /// loads of biased_ that must match, else it is read again.
+  long use_count() const
   {
-    if (size > 0 && !data_)
+    long v = shared_.load(boost::memory_order_acquire);
+    if (v & merged)
+    {
+      return v >> 2;
+    }
+    else if (is_owner())
+    {
+      return biased_count(biased_.load(boost::memory_order_relaxed)) + (v >> 2);
+    }
+
+    while (true)
     {
-      throw std::bad_alloc();
+      boost::uint64_t b = biased_.load(boost::memory_order_acquire);
+      v = shared_.load(boost::memory_order_acquire);
+      if (v & merged)
+      {
+        return v >> 2;
+      }
+      else if (biased_.load(boost::memory_order_acquire) == b)
+      {
+        return biased_count(b) + (v >> 2);
+      }
     }
   }
 
-  ~buffer()
+  inline friend void intrusive_ptr_add_ref(buffer* p)
   {
-    if (data_)
+    if (p->is_owner())
     {
-      std::free(data_);
+      p->add_biased(1);
+    }
+    else
+    {
+      p->shared_.fetch_add(shared_one, boost::memory_order_relaxed);
     }
   }
 
-public:
-  inline byte_t* data() { return data_; }
-  inline std::size_t size() const { return size_; }
+  inline friend void intrusive_ptr_release(buffer* p)
+  {
+    if (p->is_owner())
+    {
+      if (p->add_biased(-1) == 0)
+      {
+        p->merge(merged);
+      }
+    }
+    else
+    {
+      p->release_shared();
+    }
+  }
+
+private:
+  inline bool is_owner() const
+  {
+    void const* owner = owner_.load(boost::memory_order_relaxed);
+    return owner != 0 && owner == buffer_pool::current_owner();
+  }
+
+  /// Owner thread, or a merge run for it; release so a thread that sees
+  /// the buffer unshared also sees the owner's last use of it.
+  long add_biased(long delta)
+  {
+    boost::uint64_t v = biased_.load(boost::memory_order_relaxed);
+    long n = biased_count(v) + delta;
+    biased_.store(
+      (v & ~(boost::uint64_t)0xffffffff) + biased_write() + (boost::uint32_t)n,
+      boost::memory_order_release
+      );
+    return n;
+  }
+
+  /// Owner thread, or any once the owner has exited.
+  void merge(long delta)
+  {
+    owner_.store(0, boost::memory_order_relaxed);
+    if (shared_.fetch_add(delta, boost::memory_order_acq_rel) + delta == merged)
+    {
+      destroy();
+    }
+  }
 
-  inline void resize(std::size_t size)
+  void release_shared()
   {
-    if (size > size_)
+    long v =
+      shared_.fetch_sub(shared_one, boost::memory_order_acq_rel) - shared_one;
+    if (v == merged)
     {
-      void* p = std::realloc(data_, size);
-      if (!p)
+      destroy();
+    }
+    else if ((v & (merged | queued)) == 0 && (v >> 2) < 0)
+    {
+      /// Dropped a ref the owner counted, only it can settle up.
+      long old = shared_.fetch_or(queued, boost::memory_order_acq_rel);
+      if ((old & queued) != 0)
+      {
+        return;
+      }
+
+      if ((old & merged) != 0)
       {
-        throw std::bad_alloc();
+        /// The owner merged meanwhile.
+        v = shared_.fetch_and(~(long)queued, boost::memory_order_acq_rel);
+        if ((v & ~(long)queued) == merged)
+        {
+          destroy();
+        }
+        return;
       }
-      data_ = (byte_t*)p;
-      size_ = size;
+      buffer_pool::post((byte_t*)this, &buffer::merge_posted);
     }
   }
 
-  void free()
+  static void merge_posted(byte_t* data)
   {
-    delete this;
+    buffer* p = (buffer*)data;
+    long delta = -(long)queued;
+    if ((p->shared_.load(boost::memory_order_acquire) & merged) == 0)
+    {
+      long n = biased_count(p->biased_.load(boost::memory_order_relaxed));
+      delta += n * shared_one + merged;
+      p->add_biased(-n);
+    }
+    p->merge(delta);
+  }
+
+  void destroy()
+  {
+    this->~buffer();
+    buffer_pool::deallocate((byte_t*)this);
+  }
+
+  /// Keep the payload 16 bytes aligned.
+  static std::size_t header_size()
+  {
+    return (sizeof(buffer) + 15) & ~(std::size_t)15;
   }
 
 private:
-  byte_t* data_;
-  std::size_t size_;
+  /// 0 once merged.
+  boost::atomic<void const*> owner_;
+  boost::atomic<boost::uint64_t> biased_;
+  boost::atomic_long shared_;
+  std::size_t const size_;
 };
-
-typedef boost::intrusive_ptr<buffer> buffer_ptr;
 }
 }
 
@@ -0,0 +1,59 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_DETAIL_BUFFER_POOL_HPP
+#define GCE_ACTOR_DETAIL_BUFFER_POOL_HPP
+
+#include <gce/actor/config.hpp>
+
+namespace gce
+{
+namespace detail
+{
+/// Power of two size-class slabs for large msg buffers and inbox nodes.
+///
+/// Each thread keeps up to GCE_BUFFER_POOL_CACHE_SIZE freed blocks per class.
+/// A block freed on another thread (the recver's, usually) is pushed back
+/// onto its owner's lock-free remote list, which the owner takes over when
+/// its own list of that class runs dry. Blocks bigger than
+/// GCE_BUFFER_POOL_MAX_SIZE bypass the pool.
+///
+/// A pooled block's owner lives until all its blocks are freed, so it
+/// doubles as the owner thread of biased ref counts kept in the block.
+struct buffer_pool
+{
+  typedef void (*merge_t)(byte_t* data);
+
+  /// Return a block of at least size bytes; size is set to its capacity.
+  static byte_t* allocate(std::size_t& size);
+
+  /// Any thread.
+  static void deallocate(byte_t* data);
+
+  /// Calling thread's owner if it called bias(), else 0. Always 0 without
+  /// native thread locals.
+  static void const* current_owner();
+
+  /// Owner of data's block, 0 if data bypassed the pool.
+  static void const* get_owner(byte_t* data);
+
+  /// Any thread; run mrg(data) on the owner thread of data's block, at its
+  /// next allocate/deallocate or its exit. If the owner has exited already,
+  /// run mrg(data) here.
+  static void post(byte_t* data, merge_t mrg);
+
+  /// Bias ref counts of buffers the calling thread makes to it. Only for
+  /// threads that keep using the pool (context's worker threads); others
+  /// count in the shared counter from the start.
+  static void bias();
+};
+}
+}
+
+#endif /// GCE_ACTOR_DETAIL_BUFFER_POOL_HPP
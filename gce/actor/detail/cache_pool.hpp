@@ -15,6 +15,8 @@
 #include <gce/actor/actor_id.hpp>
 #include <gce/actor/detail/object_pool.hpp>
 #include <gce/detail/unique_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
 #include <boost/optional.hpp>
 #include <boost/noncopyable.hpp>
 #include <vector>
@@ -24,6 +26,7 @@
 namespace gce
 {
 class context;
+struct fairness_stat;
 class coroutine_stackful_actor;
 class coroutine_stackless_actor;
 struct attributes;
@@ -42,13 +45,48 @@ class cache_pool
   : private boost::noncopyable
 {
 public:
-  cache_pool(context& ctx, std::size_t index, bool is_slice = false);
+  cache_pool(
+    context& ctx, io_service_t& ios,
+    std::size_t index, bool is_slice = false
+    );
   ~cache_pool();
 
 public:
   inline context& get_context() { return *ctx_; }
   inline std::size_t get_index() { return index_; }
+  inline io_service_t& get_io_service() { return *ios_; }
   inline strand_t& get_strand() { return snd_; }
+  inline bool per_actor_strand() const { return per_actor_strand_; }
+
+  /// Live actors/sockets/acceptors plus queued activations; only tracked
+  /// in place_least_loaded mode, any thread.
+  inline std::size_t get_load() const
+  {
+    return load_.load(boost::memory_order_relaxed);
+  }
+
+  inline void add_load()
+  {
+    if (track_load_)
+    {
+      load_.fetch_add(1, boost::memory_order_relaxed);
+    }
+  }
+
+  inline void sub_load()
+  {
+    if (track_load_)
+    {
+      load_.fetch_sub(1, boost::memory_order_relaxed);
+    }
+  }
+
+  /// Any thread; only called in track_fairness_ mode.
+  void add_activation(duration_t, bool preempted);
+  fairness_stat get_fairness_stat() const;
+
+  /// Shared by all mailboxes of actors in this pool.
+  inline boost::atomic_size_t& get_shed_num() { return shed_num_; }
 
   coroutine_stackful_actor* get_context_switching_actor();
   coroutine_stackless_actor* get_event_based_actor();
@@ -66,18 +104,49 @@ public:
 
   void register_socket(ctxid_pair_t, aid_t skt);
   aid_t select_socket(ctxid_t ctxid = ctxid_nil, ctxid_t* target = 0);
-  aid_t select_straight_socket(ctxid_t ctxid = ctxid_nil, ctxid_t* target = 0);
   aid_t select_joint_socket(ctxid_t ctxid = ctxid_nil, ctxid_t* target = 0);
-  aid_t select_router(ctxid_t* target = 0);
   void deregister_socket(ctxid_pair_t, aid_t skt);
 
-  void add_socket(socket*);
-  void add_acceptor(acceptor*);
+  /// Return false if this cache_pool already stopped.
+  bool add_socket(socket*);
+  bool add_acceptor(acceptor*);
   void remove_socket(socket*);
   void remove_acceptor(acceptor*);
 
   void stop();
-  inline bool stopped() const { return stopped_; }
+
+private:
+  aid_t select_straight_socket(ctxid_t ctxid, ctxid_t* target);
+  aid_t select_router(ctxid_t* target);
+
+private:
+  /// In sched_actor mode actors call into their cache_pool from their own
+  /// strands, so pools and socket lists need a lock; otherwise everything
+  /// already runs in snd_ and the lock is a no-op.
+  class scoped_lock
+    : private boost::noncopyable
+  {
+  public:
+    explicit scoped_lock(cache_pool& p)
+      : mtx_(p.per_actor_strand_ ? &p.mtx_ : 0)
+    {
+      if (mtx_)
+      {
+        mtx_->lock();
+      }
+    }
+
+    ~scoped_lock()
+    {
+      if (mtx_)
+      {
+        mtx_->unlock();
+      }
+    }
+
+  private:
+    boost::mutex* mtx_;
+  };
 
 private:
   /// Ensure start from a new cache line.
@@ -85,9 +154,22 @@ private:
 
   GCE_CACHE_ALIGNED_VAR(context*, ctx_)
   GCE_CACHE_ALIGNED_VAR(std::size_t, index_)
+  GCE_CACHE_ALIGNED_VAR(io_service_t*, ios_)
   GCE_CACHE_ALIGNED_VAR(strand_t, snd_)
-
-  /// pools
+  GCE_CACHE_ALIGNED_VAR(bool const, per_actor_strand_)
+  GCE_CACHE_ALIGNED_VAR(boost::mutex, mtx_)
+  GCE_CACHE_ALIGNED_VAR(bool const, track_load_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, load_)
+
+  /// fairness_stat
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, activation_num_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, preempt_num_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic<duration_t::rep>, max_activation_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_size_t, shed_num_)
+
+  /// pools, made (and their reserve objects allocated) on first get, by the
+  /// thread that runs this cache_pool
+  GCE_CACHE_ALIGNED_VAR(bool const, is_slice_)
   GCE_CACHE_ALIGNED_VAR(boost::optional<context_switching_actor_pool_t>, context_switching_actor_pool_)
   GCE_CACHE_ALIGNED_VAR(boost::optional<event_based_actor_pool_t>, event_based_actor_pool_)
   GCE_CACHE_ALIGNED_VAR(boost::optional<socket_pool_t>, socket_pool_)
@@ -0,0 +1,192 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_DETAIL_FLAT_TABLE_HPP
+#define GCE_ACTOR_DETAIL_FLAT_TABLE_HPP
+
+#include <gce/actor/config.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace gce
+{
+namespace detail
+{
+/// Spread all bits of a 64 bits key over the low ones (murmur3 finalizer).
+inline std::size_t hash_mix(boost::uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return (std::size_t)k;
+}
+
+struct sid_hash
+{
+  inline std::size_t operator()(sid_t id) const
+  {
+    return hash_mix(id);
+  }
+};
+
+/// Open addressing hash table: one flat slot array, linear probing and
+/// backward shift erase (no tombstones), so a lookup is a few adjacent
+/// compares and no node is allocated per entry. Not thread safe.
+template <typename Key, typename Value, typename Hash>
+class flat_table
+{
+  struct slot
+  {
+    slot()
+      : used_(false)
+      , key_()
+      , val_()
+    {
+    }
+
+    bool used_;
+    Key key_;
+    Value val_;
+  };
+
+  typedef std::vector<slot> slot_list_t;
+
+public:
+  flat_table()
+    : size_(0)
+  {
+  }
+
+public:
+  inline std::size_t size() const { return size_; }
+  inline bool empty() const { return size_ == 0; }
+
+  /// Null if k not in.
+  Value* find(Key const& k)
+  {
+    if (size_ == 0)
+    {
+      return 0;
+    }
+
+    slot& s = slot_list_[locate(k)];
+    return s.used_ ? &s.val_ : 0;
+  }
+
+  /// Make room for n entries; till then operator[] won't allocate.
+  void reserve(std::size_t n)
+  {
+    while (n * 4 > slot_list_.size() * 3)
+    {
+      grow();
+    }
+  }
+
+  /// Insert a default constructed value if k not in.
+  Value& operator[](Key const& k)
+  {
+    reserve(size_ + 1);
+
+    slot& s = slot_list_[locate(k)];
+    if (!s.used_)
+    {
+      s.used_ = true;
+      s.key_ = k;
+      ++size_;
+    }
+    return s.val_;
+  }
+
+  bool erase(Key const& k)
+  {
+    if (size_ == 0)
+    {
+      return false;
+    }
+
+    std::size_t mask = slot_list_.size() - 1;
+    std::size_t i = locate(k);
+    if (!slot_list_[i].used_)
+    {
+      return false;
+    }
+
+    /// Move later slots of the probe run into the hole, unless their home
+    /// lies cyclically in (i, j].
+    std::size_t j = i;
+    while (true)
+    {
+      j = (j + 1) & mask;
+      slot& s = slot_list_[j];
+      if (!s.used_)
+      {
+        break;
+      }
+
+      std::size_t home = Hash()(s.key_) & mask;
+      bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+      if (movable)
+      {
+        slot_list_[i] = s;
+        i = j;
+      }
+    }
+
+    slot_list_[i] = slot();
+    --size_;
+    return true;
+  }
+
+  void clear()
+  {
+    if (size_ > 0)
+    {
+      std::fill(slot_list_.begin(), slot_list_.end(), slot());
+      size_ = 0;
+    }
+  }
+
+private:
+  std::size_t locate(Key const& k) const
+  {
+    std::size_t mask = slot_list_.size() - 1;
+    std::size_t i = Hash()(k) & mask;
+    while (slot_list_[i].used_ && !(slot_list_[i].key_ == k))
+    {
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  void grow()
+  {
+    slot_list_t old;
+    old.swap(slot_list_);
+    slot_list_.resize(old.empty() ? 8 : old.size() * 2);
+    size_ = 0;
+
+    for (std::size_t i=0; i<old.size(); ++i)
+    {
+      if (old[i].used_)
+      {
+        (*this)[old[i].key_] = old[i].val_;
+      }
+    }
+  }
+
+private:
+  slot_list_t slot_list_;
+  std::size_t size_;
+};
+}
+}
+
+#endif /// GCE_ACTOR_DETAIL_FLAT_TABLE_HPP
@@ -0,0 +1,187 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_DETAIL_INBOX_HPP
+#define GCE_ACTOR_DETAIL_INBOX_HPP
+
+#include <gce/actor/config.hpp>
+#include <gce/actor/detail/pack.hpp>
+#include <gce/actor/detail/buffer_pool.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/move/utility.hpp>
+#include <new>
+
+namespace gce
+{
+namespace detail
+{
+/// Intrusive multi-producer/single-consumer pack queue (Vyukov's), plus a
+/// scheduled flag, so only the first push into an idle inbox wakes up its
+/// owner, and the owner drains all queued packs in one go.
+///
+/// Nodes come from the pushing thread's buffer_pool cache and go back to it
+/// when the owner is done with them, so a steady flow allocates nothing.
+class inbox
+  : private boost::noncopyable
+{
+  struct hook
+  {
+    hook() : next_(0) {}
+    boost::atomic<hook*> next_;
+  };
+
+  struct node
+    : public hook
+  {
+    explicit node(pack& pk) : pk_(boost::move(pk)) {}
+    pack pk_;
+  };
+
+  struct node_guard
+    : private boost::noncopyable
+  {
+    explicit node_guard(node* n) : n_(n) {}
+    ~node_guard() { free_node(n_); }
+    node* n_;
+  };
+
+public:
+  inbox()
+    : head_(&stub_)
+    , tail_(&stub_)
+    , scheduled_(false)
+  {
+  }
+
+  ~inbox()
+  {
+    while (node* n = pop())
+    {
+      free_node(n);
+    }
+  }
+
+public:
+  /// Any thread; return true if caller must schedule drain in owner's strand.
+  /// pk is moved from.
+  bool push(pack& pk)
+  {
+    push_hook(make_node(pk));
+    return !scheduled_.exchange(true);
+  }
+
+  /// Owner's strand only. Return false if a producer is still linking its
+  /// pack or stop() returned true after a pack; then inbox keeps scheduled
+  /// and owner must drain again later.
+  template <typename Handler, typename Stop>
+  bool drain(Handler h, Stop stop)
+  {
+    while (true)
+    {
+      while (node* n = pop())
+      {
+        {
+          node_guard guard(n);
+          h(n->pk_);
+        }
+
+        if (stop())
+        {
+          return false;
+        }
+      }
+
+      if (!empty())
+      {
+        return false;
+      }
+
+      scheduled_.store(false);
+      if (empty() || scheduled_.exchange(true))
+      {
+        return true;
+      }
+    }
+  }
+
+private:
+  static node* make_node(pack& pk)
+  {
+    std::size_t size = sizeof(node);
+    byte_t* data = buffer_pool::allocate(size);
+    return new (data) node(pk);
+  }
+
+  static void free_node(node* n)
+  {
+    n->~node();
+    buffer_pool::deallocate((byte_t*)n);
+  }
+
+  void push_hook(hook* h)
+  {
+    h->next_.store(0, boost::memory_order_relaxed);
+    hook* prev = head_.exchange(h);
+    prev->next_.store(h, boost::memory_order_release);
+  }
+
+  node* pop()
+  {
+    hook* tail = tail_;
+    hook* next = tail->next_.load(boost::memory_order_acquire);
+    if (tail == &stub_)
+    {
+      if (next == 0)
+      {
+        return 0;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next_.load(boost::memory_order_acquire);
+    }
+
+    if (next)
+    {
+      tail_ = next;
+      return static_cast<node*>(tail);
+    }
+
+    if (tail != head_.load())
+    {
+      return 0;
+    }
+
+    push_hook(&stub_);
+    next = tail->next_.load(boost::memory_order_acquire);
+    if (next)
+    {
+      tail_ = next;
+      return static_cast<node*>(tail);
+    }
+    return 0;
+  }
+
+  bool empty() const
+  {
+    return head_.load() == tail_ && tail_->next_.load() == 0;
+  }
+
+private:
+  /// Ensure start from a new cache line.
+  byte_t pad0_[GCE_CACHE_LINE_SIZE];
+
+  GCE_CACHE_ALIGNED_VAR(boost::atomic<hook*>, head_)
+  GCE_CACHE_ALIGNED_VAR(hook*, tail_)
+  GCE_CACHE_ALIGNED_VAR(boost::atomic_bool, scheduled_)
+  hook stub_;
+};
+}
+}
+
+#endif /// GCE_ACTOR_DETAIL_INBOX_HPP
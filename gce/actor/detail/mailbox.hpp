@@ -1,11 +1,11 @@
-﻿///
-/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
-///
-/// Distributed under the Boost Software License, Version 1.0. (See accompanying
-/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
-///
-/// See https://github.com/nousxiong/gce for latest version.
-///
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
 
 #ifndef GCE_ACTOR_DETAIL_MAILBOX_HPP
 #define GCE_ACTOR_DETAIL_MAILBOX_HPP
@@ -14,11 +14,15 @@
 #include <gce/actor/response.hpp>
 #include <gce/actor/detail/request.hpp>
 #include <gce/actor/message.hpp>
+#include <gce/actor/match.hpp>
 #include <gce/actor/detail/mailbox_fwd.hpp>
+#include <gce/actor/detail/match_index.hpp>
+#include <gce/actor/detail/flat_table.hpp>
+#include <boost/atomic.hpp>
 #include <boost/variant/variant.hpp>
+#include <boost/noncopyable.hpp>
 #include <vector>
 #include <deque>
-#include <list>
 #include <map>
 
 namespace gce
@@ -26,56 +30,203 @@ namespace gce
 namespace detail
 {
 class mailbox
+  : private boost::noncopyable
 {
-  typedef std::pair<recv_t, message> recv_pair_t;
+  /// A msg, linked in its lane's FIFO, its type's match queue and its
+  /// sender's queue.
+  struct node
+  {
+    node()
+      : lane_(0)
+      , id_(0)
+      , prev_(0)
+      , next_(0)
+      , match_prev_(0)
+      , match_next_(0)
+      , sender_prev_(0)
+      , sender_next_(0)
+    {
+    }
+
+    recv_t rcv_;
+    message msg_;
+    std::size_t lane_;
+
+    /// match_index id of msg_'s type
+    std::size_t id_;
+    aid_t sender_;
+
+    node* prev_;
+    node* next_;
+    node* match_prev_;
+    node* match_next_;
+    node* sender_prev_;
+    node* sender_next_;
+  };
+
+  template <node* node::*Prev, node* node::*Next>
+  struct node_list
+  {
+    node_list()
+      : head_(0)
+      , tail_(0)
+    {
+    }
+
+    inline bool empty() const { return head_ == 0; }
+
+    /// Before pos, or at tail if pos is null.
+    inline void insert(node* pos, node* n)
+    {
+      node* prev = pos ? pos->*Prev : tail_;
+      n->*Prev = prev;
+      n->*Next = pos;
+      (prev ? prev->*Next : head_) = n;
+      (pos ? pos->*Prev : tail_) = n;
+    }
+
+    /// Keep lane order: after all of same or higher priority.
+    inline void insert_by_lane(node* n)
+    {
+      /// Usually all same lane, so stop at once.
+      node* pos = 0;
+      node* prev = tail_;
+      while (prev && prev->lane_ > n->lane_)
+      {
+        pos = prev;
+        prev = prev->*Prev;
+      }
+      insert(pos, n);
+    }
+
+    inline void erase(node* n)
+    {
+      (n->*Prev ? n->*Prev->*Next : head_) = n->*Next;
+      (n->*Next ? n->*Next->*Prev : tail_) = n->*Prev;
+      n->*Prev = 0;
+      n->*Next = 0;
+    }
+
+    node* head_;
+    node* tail_;
+  };
+
+  typedef node_list<&node::prev_, &node::next_> recv_queue_t;
+  typedef node_list<&node::match_prev_, &node::match_next_> match_queue_t;
+  typedef node_list<&node::sender_prev_, &node::sender_next_> sender_queue_t;
+
+  struct aid_hash
+  {
+    inline std::size_t operator()(aid_t const& aid) const
+    {
+      return
+        hash_mix(
+          aid.uintptr_ ^ aid.timestamp_ ^ aid.ctxid_ ^
+          ((boost::uint64_t)aid.sid_ << 32)
+          );
+    }
+  };
+
   typedef std::pair<response_t, message> res_msg_pair_t;
-  typedef std::map<sid_t, res_msg_pair_t> res_msg_list_t;
+  typedef flat_table<sid_t, res_msg_pair_t, sid_hash> res_msg_list_t;
 
 public:
-  explicit mailbox(std::size_t);
+  /// cache_match_size: match queues made up front; shed_num: counts
+  /// expired requests dropped, may be shared by many mailboxes.
+  mailbox(
+    match_index&, std::size_t cache_match_size,
+    boost::atomic_size_t& shed_num
+    );
   ~mailbox();
 
   void clear();
 
 public:
+  /// Requests past their deadline are dropped, not returned.
   bool pop(recv_t&, message&, match_list_t const&);
+
+  /// With match's from_, svc_ and pred_ filters.
+  bool pop(recv_t&, message&, match const&);
   bool pop(response_t&, message&);
   bool pop(aid_t, request_t&);
 
-  void push(aid_t, message const&);
-  void push(exit_t, message const&);
-  void push(request_t, message const&);
-  bool push(response_t, message const&);
+  /// Drop the oldest msg of the lowest priority lane, never an exit (nor
+  /// anything in the system lane). A dropped request is taken out of the
+  /// reply queue too.
+  bool drop_oldest(recv_t&, message&);
+
+  /// Recv msgs queued, exits included; responses not counted.
+  inline std::size_t size() const { return size_; }
+
+  /// msg is moved from.
+  void push(aid_t, message&);
+  void push(exit_t, message&);
+  void push(request_t, message&);
+  bool push(response_t, message&);
+
+  /// Owner won't recv res: free its response if here, else drop it when it
+  /// arrives.
+  void discard(response_t);
 
 private:
-  void add_match_msg(recv_t const&, aid_t sender, message const&);
+  bool take(recv_t&, message&, match_list_t const&);
+  bool take(recv_t&, message&, match const&);
+
+  /// If src is an expired request, take it out of the reply queue, count it
+  /// and return true.
+  bool shed(recv_t const& src);
+  void remove_request(request_t const&);
+
+  void add_match_msg(recv_t const&, aid_t sender, message&);
   bool fetch_match_msg(match_t, recv_t&, message&);
 
+  /// An exit no msg of its sender is queued ahead of.
+  bool fetch_exit(recv_t&, message&);
+  void fetch(node*, recv_t&, message&);
+  bool accept(node*, match const&, bool check_type) const;
+  void add_exit(aid_t sender, node*);
+
+  node* make_node(recv_t const&, message&);
+  void free_node(node*);
+
+  /// Unlink from both queues and free.
+  void remove(node*);
+
+  /// exit in prio_system lane, unless its sender has msgs queued; then in
+  /// the lane of its last one, so it comes after them.
+  std::size_t get_lane(message const&, aid_t sender);
+  static aid_t get_sender(recv_t const&);
+
 private:
-  typedef std::list<recv_pair_t> recv_queue_t;
-  typedef recv_queue_t::iterator recv_itr;
-  recv_queue_t recv_que_;
+  match_index& index_;
+  boost::atomic_size_t& shed_num_;
 
-  typedef std::list<recv_itr> match_queue_t;
-  typedef match_queue_t::iterator match_itr;
-  std::vector<match_queue_t> cache_match_list_;
+  /// One FIFO per priority_type; a match queue keeps its msgs ordered by
+  /// lane then arrival, so selective recv also gets urgent ones first.
+  recv_queue_t recv_que_list_[prio_num];
+  std::size_t size_;
 
-  typedef std::map<match_t, match_queue_t> match_queue_list_t;
-  match_queue_list_t match_queue_list_;
+  /// Indexed by match_index id.
+  std::vector<match_queue_t> match_queue_list_;
+
+  /// Freed nodes for reuse, linked by next_.
+  node* free_list_;
+  std::size_t free_num_;
 
   res_msg_list_t res_msg_list_;
+  flat_table<sid_t, bool, sid_hash> discard_list_;
+
+  typedef flat_table<aid_t, sender_queue_t, aid_hash> sender_list_t;
+  sender_list_t sender_list_;
 
   typedef std::deque<request_t> req_queue_t;
-  typedef std::map<aid_t, req_queue_t> wait_reply_list_t;
+  typedef flat_table<aid_t, req_queue_t, aid_hash> wait_reply_list_t;
   wait_reply_list_t wait_reply_list_;
 
-  typedef std::map<aid_t, match_itr> exit_list_t;
-  typedef std::map<svcid_t, std::pair<aid_t, match_itr> > svc_exit_list_t;
+  typedef std::map<aid_t, node*> exit_list_t;
+  typedef std::map<svcid_t, std::pair<aid_t, node*> > svc_exit_list_t;
   exit_list_t exit_list_;
   svc_exit_list_t svc_exit_list_;
-
-  req_queue_t dummy_;
-  match_queue_t dummy2_;
 };
 }
 }
@@ -0,0 +1,57 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_DETAIL_MATCH_INDEX_HPP
+#define GCE_ACTOR_DETAIL_MATCH_INDEX_HPP
+
+#include <gce/actor/config.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace gce
+{
+namespace detail
+{
+/// Per context map from msg types (atoms) to small dense ids, so mailboxes
+/// keep their match queues in a vector. Insert only, lock free; ids start
+/// from 1, 0 is shared by match_nil and all types that found no free slot
+/// within max_probe of their home slot, their queue then has to be searched
+/// by type.
+class match_index
+  : private boost::noncopyable
+{
+public:
+  /// size is rounded up to a power of 2.
+  explicit match_index(std::size_t size);
+  ~match_index();
+
+public:
+  /// Any thread. Index type if it is new; used when queueing a msg.
+  std::size_t get(match_t type);
+
+  /// Any thread. Never inserts; 0 if type was not indexed, in which case no
+  /// queued msg of type can be outside queue 0 either.
+  std::size_t find(match_t type) const;
+
+private:
+  std::size_t probe(match_t type, bool insert);
+
+  /// Bounds both lookups and inserts, a full table costs no more than this.
+  static std::size_t const max_probe = 8;
+
+private:
+  boost::scoped_array<boost::atomic<match_t> > key_list_;
+  boost::scoped_array<boost::atomic_size_t> id_list_;
+  std::size_t mask_;
+  boost::atomic_size_t next_id_;
+};
+}
+}
+
+#endif /// GCE_ACTOR_DETAIL_MATCH_INDEX_HPP
@@ -0,0 +1,99 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_DETAIL_OBJECT_HPP
+#define GCE_ACTOR_DETAIL_OBJECT_HPP
+
+#include <gce/actor/config.hpp>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <typeinfo>
+
+namespace gce
+{
+class message;
+namespace detail
+{
+/// Type-erased, immutable C++ object a message carries between local
+/// actors instead of its serialized bytes.
+class object
+  : private boost::noncopyable
+{
+public:
+  object()
+    : count_(0)
+  {
+  }
+
+  virtual ~object() {}
+
+public:
+  virtual std::type_info const& type() const = 0;
+
+  /// Serialize into m with amsg, when the msg has to leave this process.
+  virtual void write(message& m) const = 0;
+
+  inline friend void intrusive_ptr_add_ref(object* p)
+  {
+    p->count_.fetch_add(1, boost::memory_order_relaxed);
+  }
+
+  inline friend void intrusive_ptr_release(object* p)
+  {
+    if (p->count_.fetch_sub(1, boost::memory_order_release) == 1)
+    {
+      boost::atomic_thread_fence(boost::memory_order_acquire);
+      p->destroy();
+    }
+  }
+
+protected:
+  /// Called when the last ref goes.
+  virtual void destroy()
+  {
+    delete this;
+  }
+
+private:
+  boost::atomic_long count_;
+};
+
+typedef boost::intrusive_ptr<object> object_ptr;
+
+template <typename T>
+class object_impl
+  : public object
+{
+public:
+  explicit object_impl(T const& t)
+    : t_(t)
+  {
+  }
+
+public:
+  std::type_info const& type() const
+  {
+    return typeid(T);
+  }
+
+  void write(message& m) const
+  {
+    m << t_;
+  }
+
+  inline T const& get() const { return t_; }
+
+private:
+  T const t_;
+};
+}
+}
+
+#endif /// GCE_ACTOR_DETAIL_OBJECT_HPP
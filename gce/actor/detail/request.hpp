@@ -12,26 +12,70 @@
 
 #include <gce/actor/config.hpp>
 #include <gce/actor/actor_id.hpp>
+#include <boost/chrono/system_clocks.hpp>
 
 namespace gce
 {
 namespace detail
 {
+/// A request, optionally with the time its requester stops waiting for
+/// the reply; past it, the recver's mailbox drops it unprocessed.
 class request_t
 {
+  typedef boost::chrono::steady_clock::time_point time_point_t;
+
 public:
-  request_t() : id_(sid_nil) {}
-  request_t(sid_t id, aid_t aid) : id_(id), aid_(aid) {}
+  request_t() : id_(sid_nil), deadline_(time_point_t::max()) {}
+  request_t(sid_t id, aid_t aid) : id_(id), aid_(aid), deadline_(time_point_t::max()) {}
+
+  /// Deadline tmo from now; none if tmo not less than infin.
+  request_t(sid_t id, aid_t aid, duration_t tmo)
+    : id_(id)
+    , aid_(aid)
+    , deadline_(time_point_t::max())
+  {
+    if (tmo < infin)
+    {
+      deadline_ =
+        boost::chrono::steady_clock::now() +
+        boost::chrono::duration_cast<time_point_t::duration>(tmo);
+    }
+  }
+
   ~request_t() {}
 
 public:
   inline bool valid() const { return id_ != sid_nil; }
   inline sid_t get_id() const { return id_; }
   inline aid_t get_aid() const { return aid_; }
+  inline bool has_deadline() const { return deadline_ != time_point_t::max(); }
+
+  /// Time left before deadline, zero if passed; infin if none. Sockets send
+  /// this instead of the deadline, clocks of two hosts don't agree.
+  inline duration_t get_timeout() const
+  {
+    if (!has_deadline())
+    {
+      return infin;
+    }
+
+    time_point_t now = boost::chrono::steady_clock::now();
+    if (now >= deadline_)
+    {
+      return zero;
+    }
+    return boost::chrono::duration_cast<duration_t>(deadline_ - now);
+  }
+
+  inline bool expired() const
+  {
+    return has_deadline() && boost::chrono::steady_clock::now() >= deadline_;
+  }
 
 private:
   sid_t id_;
   aid_t aid_;
+  time_point_t deadline_;
 };
 }
 }
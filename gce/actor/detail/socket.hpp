@@ -21,6 +21,7 @@
 #include <gce/actor/detail/pack.hpp>
 #include <gce/actor/match.hpp>
 #include <gce/actor/detail/buffer_ref.hpp>
+#include <boost/scoped_array.hpp>
 #include <map>
 #include <deque>
 
@@ -117,7 +118,8 @@ private:
   timer_t sync_;
   std::size_t tmr_sid_;
 
-  byte_t recv_buffer_[GCE_SOCKET_RECV_CACHE_SIZE];
+  /// allocated on first init, pooled sockets that never run don't pay it
+  boost::scoped_array<byte_t> recv_buffer_;
   detail::buffer_ref recv_cache_;
 
   bool conn_;
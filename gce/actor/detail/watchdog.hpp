@@ -0,0 +1,113 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_DETAIL_WATCHDOG_HPP
+#define GCE_ACTOR_DETAIL_WATCHDOG_HPP
+
+#include <gce/actor/config.hpp>
+#include <gce/actor/actor_id.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+namespace gce
+{
+/// Called with actor id, msg type (match_nil if not a msg) and how long
+/// the activation had run; from the watchdog or the stalled thread.
+typedef boost::function<void (aid_t, match_t, duration_t)> stall_callback_t;
+
+namespace detail
+{
+/// Times every actor activation of the threads that run them; an
+/// activation longer than threshold is reported once, by the watchdog
+/// thread while it is still running, or else by its own thread when done.
+class watchdog
+  : private boost::noncopyable
+{
+  typedef boost::chrono::steady_clock clock_t;
+
+  struct slot
+  {
+    slot()
+      : depth_(0)
+      , running_(false)
+      , reported_(false)
+      , type_(match_nil)
+    {
+    }
+
+    /// Only touched by its own thread.
+    std::size_t depth_;
+
+    /// Guarded by mtx_.
+    boost::mutex mtx_;
+    bool running_;
+    bool reported_;
+    clock_t::time_point begin_;
+    aid_t aid_;
+    match_t type_;
+  };
+
+public:
+  watchdog(duration_t threshold, stall_callback_t const& cb);
+  ~watchdog();
+
+public:
+  /// Nested activations (e.g. resume inside handle_recv) count as one.
+  void begin(aid_t, match_t type);
+  void end();
+
+  class scope
+    : private boost::noncopyable
+  {
+  public:
+    scope(watchdog* wdg, aid_t aid, match_t type)
+      : wdg_(wdg)
+    {
+      if (wdg_)
+      {
+        wdg_->begin(aid, type);
+      }
+    }
+
+    ~scope()
+    {
+      if (wdg_)
+      {
+        wdg_->end();
+      }
+    }
+
+  private:
+    watchdog* wdg_;
+  };
+
+private:
+  slot& get_slot();
+  static void no_cleanup(slot*);
+  void run();
+  void report(aid_t, match_t, duration_t);
+
+private:
+  duration_t const threshold_;
+  stall_callback_t cb_;
+
+  boost::mutex slot_list_mtx_;
+  std::vector<boost::shared_ptr<slot> > slot_list_;
+  boost::thread_specific_ptr<slot> curr_slot_;
+  boost::thread thr_;
+};
+}
+}
+
+#endif /// GCE_ACTOR_DETAIL_WATCHDOG_HPP
@@ -0,0 +1,136 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_GATHER_HPP
+#define GCE_ACTOR_GATHER_HPP
+
+#include <gce/actor/config.hpp>
+#include <gce/actor/actor.hpp>
+#include <gce/actor/basic_actor.hpp>
+#include <gce/actor/response.hpp>
+#include <gce/actor/message.hpp>
+
+namespace gce
+{
+namespace detail
+{
+template <typename Sender, typename Recvers>
+inline void request_each(
+  Sender& sender, Recvers const& recvers, message const& m,
+  duration_t tmo, response_list_t& pending
+  )
+{
+  typedef typename Recvers::const_iterator iterator_t;
+  pending.reserve(pending.size() + recvers.size());
+  for (iterator_t itr(recvers.begin()), end(recvers.end()); itr != end; ++itr)
+  {
+    pending.push_back(sender.request(*itr, m, tmo));
+  }
+}
+}
+///----------------------------------------------------------------------------
+/// Gather responses
+///----------------------------------------------------------------------------
+/// Wait for every one of pending under one deadline, waking up once when
+/// the last arrives. Answered ones move to batch (an exited recver answers
+/// with its exit msg), unanswered ones stay in pending. Return number moved.
+template <typename Recver>
+inline std::size_t recv_all(
+  Recver& recver, response_list_t& pending, res_batch_t& batch,
+  duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
+  )
+{
+  return recver.recv_responses(pending, batch, tmo, true);
+}
+///----------------------------------------------------------------------------
+/// As recv_all, but return as soon as any answered; all answers that
+/// arrived with the first one come along.
+template <typename Recver>
+inline std::size_t recv_any(
+  Recver& recver, response_list_t& pending, res_batch_t& batch,
+  duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
+  )
+{
+  return recver.recv_responses(pending, batch, tmo, false);
+}
+///----------------------------------------------------------------------------
+inline void recv_all(
+  actor<stackless>& recver, response_list_t& pending, res_batch_t& batch,
+  duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
+  )
+{
+  recver.recv_responses(pending, batch, tmo, true);
+}
+///----------------------------------------------------------------------------
+inline void recv_any(
+  actor<stackless>& recver, response_list_t& pending, res_batch_t& batch,
+  duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
+  )
+{
+  recver.recv_responses(pending, batch, tmo, false);
+}
+///----------------------------------------------------------------------------
+/// Scatter-gather
+///----------------------------------------------------------------------------
+/// Request m from each of recvers (aid_t or svcid_t), with tmo as their
+/// deadline too, then recv_all/recv_any. Responses not gathered (the late
+/// ones) are discarded, so they don't pile up in the mailbox.
+template <typename Sender, typename Recvers>
+inline std::size_t request_all(
+  Sender& sender, Recvers const& recvers, message const& m, res_batch_t& batch,
+  duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
+  )
+{
+  response_list_t pending;
+  detail::request_each(sender, recvers, m, tmo, pending);
+  std::size_t n = recv_all(sender, pending, batch, tmo);
+  sender.discard(pending);
+  return n;
+}
+///----------------------------------------------------------------------------
+template <typename Sender, typename Recvers>
+inline std::size_t request_any(
+  Sender& sender, Recvers const& recvers, message const& m, res_batch_t& batch,
+  duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
+  )
+{
+  response_list_t pending;
+  detail::request_each(sender, recvers, m, tmo, pending);
+  std::size_t n = recv_any(sender, pending, batch, tmo);
+  sender.discard(pending);
+  return n;
+}
+///----------------------------------------------------------------------------
+/// Stackless ones need pending to outlive their GCE_YIELD; after it, pass
+/// what is left in pending to discard unless still waiting on it.
+template <typename Recvers>
+inline void request_all(
+  actor<stackless>& sender, Recvers const& recvers, message const& m,
+  response_list_t& pending, res_batch_t& batch,
+  duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
+  )
+{
+  detail::request_each(sender, recvers, m, tmo, pending);
+  recv_all(sender, pending, batch, tmo);
+}
+///----------------------------------------------------------------------------
+template <typename Recvers>
+inline void request_any(
+  actor<stackless>& sender, Recvers const& recvers, message const& m,
+  response_list_t& pending, res_batch_t& batch,
+  duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
+  )
+{
+  detail::request_each(sender, recvers, m, tmo, pending);
+  recv_any(sender, pending, batch, tmo);
+}
+///----------------------------------------------------------------------------
+}
+
+#endif /// GCE_ACTOR_GATHER_HPP
@@ -11,27 +11,35 @@
 #define GCE_ACTOR_IMPL_PROTOCOL_HPP
 
 #include <gce/actor/config.hpp>
+#include <gce/actor/message.hpp>
 
 namespace gce
 {
 namespace msg
 {
+/// Sent with login and login_ret, a peer of another version is refused;
+/// bump it when header or any system msg layout changes.
+/// 2: header gained prio_.
+static boost::uint16_t const protocol_version = 2;
+
 struct header
 {
   header()
     : size_(0)
     , type_(match_nil)
     , tag_offset_(u32_nil)
+    , prio_(prio_normal)
   {
   }
 
   boost::uint32_t size_;
   match_t type_;
   boost::uint32_t tag_offset_;
+  boost::uint8_t prio_;
 };
 }
 }
 
-GCE_PACK(gce::msg::header, (size_&sfix)(type_)(tag_offset_));
+GCE_PACK(gce::msg::header, (size_&sfix)(type_)(tag_offset_)(prio_));
 
 #endif /// GCE_ACTOR_IMPL_PROTOCOL_HPP
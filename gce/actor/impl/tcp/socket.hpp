@@ -28,8 +28,11 @@ public:
   ~socket();
 
 public:
-  void init(gce::detail::cache_pool* user);
-  void send(byte_t const*, std::size_t, byte_t const*, std::size_t);
+  void init(strand_t& snd, net_option const& opt);
+  void send(
+    byte_t const*, std::size_t, byte_t const*, std::size_t,
+    bool urgent = false
+    );
   std::size_t recv(byte_t*, std::size_t, yield_t);
   void connect(yield_t);
   void close();
@@ -40,11 +43,12 @@ public:
 
 private:
   void close_socket();
+  void set_busy_poll();
   void begin_send();
   void end_send(errcode_t const&);
 
 private:
-  gce::detail::cache_pool* user_;
+  strand_t* snd_;
   boost::asio::ip::tcp::resolver reso_;
   boost::asio::ip::tcp::socket sock_;
   std::string const host_;
@@ -56,9 +60,11 @@ private:
   std::size_t sending_buffer_;
   std::size_t standby_buffer_;
   boost::array<gce::detail::bytes_t, 2> send_buffer_;
+  boost::array<gce::detail::bytes_t, 2> urgent_buffer_;
 
   timer_t sync_;
   bool waiting_end_;
+  std::size_t busy_poll_;
 };
 typedef boost::shared_ptr<socket> socket_ptr;
 }
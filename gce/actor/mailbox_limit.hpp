@@ -0,0 +1,79 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_MAILBOX_LIMIT_HPP
+#define GCE_ACTOR_MAILBOX_LIMIT_HPP
+
+#include <gce/actor/config.hpp>
+#include <gce/actor/actor_id.hpp>
+
+namespace gce
+{
+/// What a full mailbox does with a new msg. Exits, links and responses
+/// are never held back or dropped. A dropped or rejected request is always
+/// answered with an exit_overflow exit msg, so its requester won't wait.
+enum overflow_policy
+{
+  /// Drop the new msg.
+  overflow_drop_newest = 0,
+
+  /// Drop the oldest msg of the lowest priority lane, then take the new one.
+  overflow_drop_oldest,
+
+  /// Drop the new msg and send its sender an overflow msg:
+  /// (aid_t recver, match_t type).
+  overflow_reject,
+
+  /// Hold new user msgs back, in order, until recv makes room; exits, links
+  /// and responses still come in past them. At most capacity_ msgs are held
+  /// back, past that new ones are rejected as by overflow_reject.
+  overflow_block
+};
+
+/// Sent to a sender whose msg was rejected.
+static match_t const overflow = atom("gce_overflow");
+
+/// Sent to mailbox_limit::alarm_ when a mailbox reaches its high water:
+/// (aid_t actor, boost::uint64_t size). Sent again only after the mailbox
+/// drained to half of it.
+static match_t const overload = atom("gce_overload");
+
+struct mailbox_limit
+{
+  mailbox_limit()
+    : capacity_(0)
+    , policy_(overflow_drop_newest)
+    , high_water_(0)
+  {
+  }
+
+  explicit mailbox_limit(
+    std::size_t capacity,
+    overflow_policy policy = overflow_drop_newest,
+    aid_t alarm = aid_t(),
+    std::size_t high_water = 0
+    )
+    : capacity_(capacity)
+    , policy_(policy)
+    , alarm_(alarm)
+    , high_water_(high_water == 0 ? capacity : high_water)
+  {
+  }
+
+  /// Max msgs queued in mailbox, 0 for unbounded.
+  std::size_t capacity_;
+  overflow_policy policy_;
+
+  /// Who gets the overload msg (e.g. a supervisor), none if invalid.
+  aid_t alarm_;
+  std::size_t high_water_;
+};
+}
+
+#endif /// GCE_ACTOR_MAILBOX_LIMIT_HPP
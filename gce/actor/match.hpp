@@ -11,9 +11,17 @@
 #define GCE_ACTOR_MATCH_HPP
 
 #include <gce/actor/config.hpp>
+#include <gce/actor/actor_id.hpp>
+#include <gce/actor/service_id.hpp>
+#include <boost/function.hpp>
 
 namespace gce
 {
+class message;
+
+/// Called with a candidate msg's sender; true to take it.
+typedef boost::function<bool (aid_t, message const&)> match_pred_t;
+
 struct match
 {
   match()
@@ -76,10 +84,62 @@ struct match
   {
     timeout_ = infin;
     match_list_.clear();
+    from_ = aid_t();
+    svc_ = svcid_t();
+    pred_.clear();
   }
 
   duration_t timeout_;
   match_list_t match_list_;
+
+  /// Only msgs from this actor; the mailbox indexes msgs by sender, so this
+  /// doesn't scan other senders' msgs. Like svc_ and pred_, it doesn't
+  /// hold back exit msgs in match_list_, so a filtered recv still sees
+  /// linked actors quit.
+  aid_t from_;
+
+  /// Only msgs from the actor registered as this service (resolved when
+  /// recv begins; for a remote one, senders whose aid carries it).
+  svcid_t svc_;
+
+  /// Only msgs it accepts; tried on the candidates the above select.
+  match_pred_t pred_;
+};
+
+/// A match set fixed at compile time, e.g. self.recv(msg, match_of<1, 2>());
+/// it is filled inline, with no per recv list building or allocation.
+template <
+  match_t T1,
+  match_t T2 = match_nil,
+  match_t T3 = match_nil,
+  match_t T4 = match_nil,
+  match_t T5 = match_nil,
+  match_t T6 = match_nil,
+  match_t T7 = match_nil
+  >
+struct match_of
+  : public match
+{
+  explicit match_of(duration_t tmo = infin)
+    : match(tmo)
+  {
+    add(T1);
+    add(T2);
+    add(T3);
+    add(T4);
+    add(T5);
+    add(T6);
+    add(T7);
+  }
+
+private:
+  void add(match_t type)
+  {
+    if (type != match_nil)
+    {
+      match_list_.push_back(type);
+    }
+  }
 };
 }
 
@@ -19,11 +19,13 @@
 #include <gce/actor/detail/spawn.hpp>
 #include <gce/actor/detail/link.hpp>
 #include <gce/actor/detail/exit.hpp>
+#include <gce/actor/detail/object.hpp>
 #include <gce/amsg/amsg.hpp>
 #include <gce/amsg/zerocopy.hpp>
 #include <boost/variant/variant.hpp>
 #include <boost/variant/get.hpp>
 #include <boost/utility/string_ref.hpp>
+#include <boost/move/utility.hpp>
 #include <utility>
 #include <iostream>
 
@@ -39,6 +41,7 @@ namespace detail
 class socket;
 static match_t const tag_aid_t = atom("gce_aid_t");
 static match_t const tag_request_t = atom("gce_request_t");
+static match_t const tag_dl_request_t = atom("gce_dl_req_t");
 static match_t const tag_link_t = atom("gce_link_t");
 static match_t const tag_exit_t = atom("gce_exit_t");
 static match_t const tag_response_t = atom("gce_response_t");
@@ -51,26 +54,45 @@ typedef boost::variant<
   > tag_t;
 }
 
+/// Mailbox lane of a message, lower is served first. Msgs of one sender
+/// keep their order within a lane only: a later msg of a lower lane may
+/// overtake earlier ones of higher lanes, on a socket as in the mailbox.
+enum priority_type
+{
+  /// exit, link, response and spawn signals
+  prio_system = 0,
+  prio_urgent,
+  prio_normal,
+
+  prio_num
+};
+
 class message
 {
 public:
   message()
     : type_(match_nil)
     , tag_offset_(u32_nil)
+    , prio_(prio_normal)
     , buf_(small_, GCE_SMALL_MSG_SIZE)
+    , obj_read_(false)
   {
   }
 
   message(match_t type)
     : type_(type)
     , tag_offset_(u32_nil)
+    , prio_(prio_normal)
     , buf_(small_, GCE_SMALL_MSG_SIZE)
+    , obj_read_(false)
   {
   }
 
   message(byte_t const* data, std::size_t size)
     : type_(match_nil)
     , tag_offset_(u32_nil)
+    , prio_(prio_normal)
+    , obj_read_(false)
   {
     if (size <= GCE_SMALL_MSG_SIZE)
     {
@@ -91,6 +113,8 @@ public:
     )
     : type_(type)
     , tag_offset_(tag_offset)
+    , prio_(prio_normal)
+    , obj_read_(false)
   {
     if (size <= GCE_SMALL_MSG_SIZE)
     {
@@ -108,9 +132,12 @@ public:
   message(message const& other)
     : type_(other.type_)
     , tag_offset_(other.tag_offset_)
+    , prio_(other.prio_)
+    , obj_read_(false)
   {
     detail::buffer_ref const& buf = other.buf_;
     large_ = other.large_;
+    obj_ = other.obj_;
     if (other.is_small())
     {
       buf_.reset(small_, GCE_SMALL_MSG_SIZE);
@@ -130,6 +157,9 @@ public:
     {
       type_ = rhs.type_;
       tag_offset_ = rhs.tag_offset_;
+      prio_ = rhs.prio_;
+      obj_ = rhs.obj_;
+      obj_read_ = false;
       detail::buffer_ref const& buf = rhs.buf_;
       buf_.clear();
 
@@ -154,6 +184,33 @@ public:
     return *this;
   }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  /// Take other's large buffer and object, no refcount traffic; other is
+  /// left empty. An inline (small) payload still copies its written bytes.
+  message(message&& other)
+    : type_(other.type_)
+    , tag_offset_(other.tag_offset_)
+    , prio_(other.prio_)
+    , obj_read_(false)
+  {
+    steal(other);
+  }
+
+  message& operator=(message&& rhs)
+  {
+    if (this != &rhs)
+    {
+      type_ = rhs.type_;
+      tag_offset_ = rhs.tag_offset_;
+      prio_ = rhs.prio_;
+      buf_.clear();
+      large_.reset();
+      steal(rhs);
+    }
+    return *this;
+  }
+#endif
+
   inline byte_t const* data() const
   {
     return buf_.data();
@@ -163,10 +220,42 @@ public:
   inline match_t get_type() const { return type_; }
   inline boost::uint32_t get_tag_offset() const { return tag_offset_; }
   inline void set_type(match_t type) { type_ = type; }
+  inline priority_type get_priority() const { return (priority_type)prio_; }
+
+  /// Kept across sockets; out of range means prio_normal.
+  inline void set_priority(priority_type prio)
+  {
+    prio_ = prio >= prio_system && prio < prio_num ? prio : prio_normal;
+  }
+
+  /// Carry t as is to local recvers instead of its bytes; only when this
+  /// msg goes through a socket, t is serialized (as by <<). A typed msg
+  /// carries t alone, streaming other args in serializes t first.
+  template <typename T>
+  void set_object(T const& t)
+  {
+    BOOST_ASSERT(buf_.write_size() == 0);
+    obj_.reset(new detail::object_impl<T>(t));
+    obj_read_ = false;
+  }
+
+  /// The carried object if it is a T, else 0; shared by all copies.
+  template <typename T>
+  T const* get_object() const
+  {
+    if (obj_ && obj_->type() == typeid(T))
+    {
+      return &static_cast<detail::object_impl<T> const*>(obj_.get())->get();
+    }
+    return 0;
+  }
+
+  inline bool has_object() const { return obj_.get() != 0; }
 
   template <typename T>
   message& operator<<(T const& t)
   {
+    flatten();
     boost::amsg::error_code_t ec = boost::amsg::success;
     std::size_t size = boost::amsg::size_of(t, ec);
     if (ec != boost::amsg::success)
@@ -189,9 +278,23 @@ public:
     return *this;
   }
 
+  /// Reading the carried object consumes it, as reading its bytes would.
   template <typename T>
   message& operator>>(T& t)
   {
+    if (obj_read_)
+    {
+      throw std::runtime_error("read data overflow");
+    }
+
+    if (T const* obj = get_object<T>())
+    {
+      t = *obj;
+      obj_read_ = true;
+      return *this;
+    }
+
+    flatten();
     boost::amsg::zero_copy_buffer reader(
       buf_.get_read_data(), buf_.remain_read_size()
       );
@@ -208,6 +311,13 @@ public:
 
   message& operator<<(message const m)
   {
+    if (m.has_object())
+    {
+      message flat(m);
+      flat.flatten();
+      return *this << flat;
+    }
+
     boost::uint32_t msg_size = (boost::uint32_t)m.size();
     match_t msg_type = m.get_type();
     boost::uint32_t tag_offset = m.tag_offset_;
@@ -403,6 +513,7 @@ private:
     svcid_t svc, aid_t skt, bool is_err_ret
     )
   {
+    flatten();
     tag_offset_ = (boost::uint32_t)buf_.write_size();
     if (aid_t* aid = boost::get<aid_t>(&tag))
     {
@@ -410,7 +521,19 @@ private:
     }
     else if (detail::request_t* req = boost::get<detail::request_t>(&tag))
     {
-      *this << detail::tag_request_t << req->get_id() << req->get_aid();
+      if (req->has_deadline())
+      {
+        /// In ms, duration_t's period differs between platforms.
+        boost::int64_t tmo =
+          boost::chrono::duration_cast<boost::chrono::milliseconds>(
+            req->get_timeout()
+            ).count();
+        *this << detail::tag_dl_request_t << req->get_id() << req->get_aid() << tmo;
+      }
+      else
+      {
+        *this << detail::tag_request_t << req->get_id() << req->get_aid();
+      }
     }
     else if (detail::link_t* link = boost::get<detail::link_t>(&tag))
     {
@@ -471,6 +594,14 @@ private:
         *this >> id >> aid;
         tag = detail::request_t(id, aid);
       }
+      else if (tag_type == detail::tag_dl_request_t)
+      {
+        sid_t id;
+        aid_t aid;
+        boost::int64_t tmo;
+        *this >> id >> aid >> tmo;
+        tag = detail::request_t(id, aid, boost::chrono::milliseconds(tmo));
+      }
       else if (tag_type == detail::tag_link_t)
       {
         boost::uint16_t type;
@@ -533,12 +664,17 @@ private:
     std::size_t new_buf_capacity = old_buf_capacity;
     if (new_buf_size > old_buf_capacity)
     {
-      std::size_t diff = new_buf_size - old_buf_capacity;
+      /// Grow geometrically, building a large msg reallocates O(log n) times.
+      std::size_t diff = old_buf_capacity;
       if (diff < GCE_MSG_MIN_GROW_SIZE)
       {
         diff = GCE_MSG_MIN_GROW_SIZE;
       }
       new_buf_capacity = old_buf_capacity + diff;
+      if (new_buf_capacity < new_buf_size)
+      {
+        new_buf_capacity = new_buf_size;
+      }
     }
 
     if (is_small())
@@ -547,38 +683,83 @@ private:
       {
         make_large(new_buf_capacity);
         std::memcpy(large_->data(), buf_.data(), buf_.write_size());
-        buf_.reset(large_->data(), new_buf_capacity);
+        buf_.reset(large_->data(), large_->size());
       }
     }
     else
     {
       BOOST_ASSERT(large_);
-      /// copy-on-write
-      if (large_->use_count() > 1)
+      /// copy-on-write, or move to a bigger block
+      if (large_->use_count() > 1 || new_buf_capacity > large_->size())
       {
         detail::buffer_ptr tmp = large_;
         make_large(new_buf_capacity);
         std::memcpy(large_->data(), tmp->data(), buf_.write_size());
       }
-      else
-      {
-        large_->resize(new_buf_capacity);
-      }
-      buf_.reset(large_->data(), new_buf_capacity);
+      buf_.reset(large_->data(), large_->size());
+    }
+  }
+
+  /// Move other's payload into this, which holds none; reset other.
+  inline void steal(message& other)
+  {
+    std::size_t size = other.buf_.write_size();
+    obj_.swap(other.obj_);
+    other.obj_.reset();
+    obj_read_ = false;
+    other.obj_read_ = false;
+    if (other.is_small())
+    {
+      buf_.reset(small_, GCE_SMALL_MSG_SIZE);
+      std::memcpy(small_, other.small_, size);
+    }
+    else
+    {
+      BOOST_ASSERT(other.large_);
+      large_.swap(other.large_);
+      buf_.reset(large_->data(), large_->size());
     }
+    buf_.write(size);
+
+    other.buf_.clear();
+    other.buf_.reset(other.small_, GCE_SMALL_MSG_SIZE);
+    other.large_.reset();
+    other.tag_offset_ = u32_nil;
   }
 
   inline void make_large(std::size_t size)
   {
-    large_.reset(new detail::buffer(size));
+    large_ = detail::buffer::make(size);
+  }
+
+  /// Serialize the carried object into buf_, if any; if it was read,
+  /// so are its bytes.
+  inline void flatten()
+  {
+    if (obj_)
+    {
+      detail::object_ptr obj;
+      obj.swap(obj_);
+      obj->write(*this);
+      if (obj_read_)
+      {
+        buf_.read(buf_.write_size());
+        obj_read_ = false;
+      }
+    }
   }
 
 private:
   match_t type_;
   boost::uint32_t tag_offset_;
+  boost::uint8_t prio_;
   byte_t small_[GCE_SMALL_MSG_SIZE];
   detail::buffer_ptr large_;
   detail::buffer_ref buf_;
+  detail::object_ptr obj_;
+
+  /// obj_ was taken by >>
+  bool obj_read_;
 
   friend class basic_actor;
   friend class coroutine_stackful_actor;
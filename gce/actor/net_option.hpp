@@ -23,6 +23,8 @@ struct net_option
     , init_reconn_try_(2)
     , reconn_period_(10)
     , reconn_try_(3)
+    , busy_poll_(0)
+    , pool_(match_nil)
   {
   }
 
@@ -32,6 +34,8 @@ struct net_option
   std::size_t init_reconn_try_; /// init conn, how many try to reconnect before give up
   seconds_t reconn_period_; /// in one reconn, between two connects' period
   std::size_t reconn_try_; /// how many try to reconnect before drop cache msgs
+  std::size_t busy_poll_; /// usecs a read may busy poll the nic (linux SO_BUSY_POLL), 0 off
+  match_t pool_; /// named pool to run socket/acceptor on, match_nil for attributes::io_pool_
 };
 }
 
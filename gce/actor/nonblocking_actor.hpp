@@ -54,17 +54,17 @@ public:
     base_type::pri_relay_svc(des, m);
   }
 
-  inline response_t request(aid_t recver, message const& m)
+  inline response_t request(aid_t recver, message const& m, duration_t tmo = infin)
   {
     response_t res(base_type::new_request(), get_aid(), recver);
-    base_type::pri_request(res, recver, m);
+    base_type::pri_request(res, recver, m, tmo);
     return res;
   }
 
-  inline response_t request(svcid_t recver, message const& m)
+  inline response_t request(svcid_t recver, message const& m, duration_t tmo = infin)
   {
     response_t res(base_type::new_request(), get_aid(), recver);
-    base_type::pri_request_svc(res, recver, m);
+    base_type::pri_request_svc(res, recver, m, tmo);
     return res;
   }
 
@@ -73,6 +73,33 @@ public:
     base_type::pri_reply(recver, m);
   }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  inline void send(aid_t recver, message&& m)
+  {
+    base_type::pri_send(recver, std::move(m));
+  }
+
+  inline void send(svcid_t recver, message&& m)
+  {
+    base_type::pri_send_svc(recver, std::move(m));
+  }
+
+  inline void relay(aid_t des, message&& m)
+  {
+    base_type::pri_relay(des, std::move(m));
+  }
+
+  inline void relay(svcid_t des, message&& m)
+  {
+    base_type::pri_relay_svc(des, std::move(m));
+  }
+
+  inline void reply(aid_t recver, message&& m)
+  {
+    base_type::pri_reply(recver, std::move(m));
+  }
+#endif
+
   inline void link(aid_t target)
   {
     base_type::pri_link(target);
@@ -84,8 +111,12 @@ public:
   }
 
   aid_t recv(message&, match_list_t const& match_list = match_list_t());
+  aid_t recv(message&, match const&);
   aid_t recv(response_t, message&);
 
+  /// Append up to max_n matching msgs to batch, never wait.
+  std::size_t recv_batch(msg_batch_t& batch, std::size_t max_n, match const& mach = match());
+
 public:
   /// internal use
   void on_recv(detail::pack&, base_type::send_hint);
@@ -0,0 +1,27 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_ACTOR_OFFLOAD_HPP
+#define GCE_ACTOR_OFFLOAD_HPP
+
+#include <gce/actor/config.hpp>
+#include <gce/actor/basic_actor.hpp>
+
+namespace gce
+{
+/// Run a blocking call out of the actor's strand; stackful actor returns
+/// when f done, stackless one must GCE_YIELD it.
+template <typename Actor>
+inline void offload(Actor& self, offload_func_t const& f)
+{
+  self.offload(f);
+}
+}
+
+#endif /// GCE_ACTOR_OFFLOAD_HPP
@@ -28,7 +28,7 @@ inline bool find_exit(match_t type)
   return type == exit;
 }
 
-inline bool check_exit(std::vector<match_t>& match_list)
+inline bool check_exit(match_list_t& match_list)
 {
   if (match_list.empty())
   {
@@ -36,7 +36,7 @@ inline bool check_exit(std::vector<match_t>& match_list)
   }
   else
   {
-    std::vector<match_t>::iterator itr =
+    match_list_t::iterator itr =
       std::find_if(
         match_list.begin(),
         match_list.end(),
@@ -79,7 +79,7 @@ inline aid_t recv(actor<nonblocked>& recver, message& msg, match& mach)
     mach.match_list_.push_back(exit);
   }
 
-  aid_t sender = recver.recv(msg, mach.match_list_);
+  aid_t sender = recver.recv(msg, mach);
   if (!has_exit && msg.get_type() == exit)
   {
     exit_code_t exc;
@@ -121,6 +121,65 @@ inline aid_t recv(actor<nonblocked>& recver, response_t res, message& msg, durat
   }
   return sender;
 }
+inline void check_batch_exit(
+  msg_batch_t& batch, std::size_t old_size, bool add_exit
+  )
+{
+  if (!add_exit)
+  {
+    return;
+  }
+
+  for (std::size_t i=old_size; i<batch.size(); ++i)
+  {
+    message& msg = batch[i].second;
+    if (msg.get_type() == exit)
+    {
+      exit_code_t exc;
+      std::string errmsg;
+      msg >> exc >> errmsg;
+      throw std::runtime_error(errmsg);
+    }
+  }
+}
+
+template <typename Recver>
+inline std::size_t recv_batch(
+  Recver& recver, msg_batch_t& batch, std::size_t max_n, match& mach
+  )
+{
+  bool add_exit = check_exit(mach.match_list_);
+  if (add_exit)
+  {
+    mach.match_list_.push_back(exit);
+  }
+
+  std::size_t old_size = batch.size();
+  std::size_t n = recver.recv_batch(batch, max_n, mach);
+  check_batch_exit(batch, old_size, add_exit);
+
+  if (n == 0 && max_n > 0)
+  {
+    throw std::runtime_error("recv timeout");
+  }
+  return n;
+}
+
+inline std::size_t recv_batch(
+  actor<nonblocked>& recver, msg_batch_t& batch, std::size_t max_n, match& mach
+  )
+{
+  bool add_exit = check_exit(mach.match_list_);
+  if (add_exit)
+  {
+    mach.match_list_.push_back(exit);
+  }
+
+  std::size_t old_size = batch.size();
+  std::size_t n = recver.recv_batch(batch, max_n, mach);
+  check_batch_exit(batch, old_size, add_exit);
+  return n;
+}
 ///------------------------------------------------------------------------------
 /// recv stackless
 ///------------------------------------------------------------------------------
@@ -234,6 +293,29 @@ inline void handle_recv5(
     recver.resume();
   }
 }
+
+inline void handle_recv_batch(
+  actor<stackless>& recver, msg_batch_t& batch,
+  std::size_t old_size, bool add_exit
+  )
+{
+  if (add_exit)
+  {
+    for (std::size_t i=old_size; i<batch.size(); ++i)
+    {
+      message& msg = batch[i].second;
+      if (msg.get_type() == exit)
+      {
+        exit_code_t exc;
+        std::string errmsg;
+        msg >> exc >> errmsg;
+        recver.get_actor().quit(exc, errmsg);
+        return;
+      }
+    }
+  }
+  recver.resume();
+}
 }
 ///----------------------------------------------------------------------------
 /// Receive
@@ -451,6 +533,34 @@ inline void recv(
     );
 }
 ///----------------------------------------------------------------------------
+/// Receive batch
+///----------------------------------------------------------------------------
+/// Append up to max_n msgs matching mach to batch, in arrival order; wait
+/// only if none is there yet.
+template <typename Recver>
+inline std::size_t recv_batch(
+  Recver& recver, msg_batch_t& batch, std::size_t max_n, match mach = match()
+  )
+{
+  return detail::recv_batch(recver, batch, max_n, mach);
+}
+///----------------------------------------------------------------------------
+/// Resume when batch got at least one msg, or timed out with batch unchanged.
+inline void recv_batch(
+  actor<stackless>& recver, msg_batch_t& batch,
+  std::size_t max_n, match mach = match()
+  )
+{
+  bool add_exit = detail::begin_recv(mach);
+  recver.recv_batch(
+    boost::bind(
+      &detail::handle_recv_batch, _1,
+      boost::ref(batch), batch.size(), add_exit
+      ),
+    batch, max_n, mach
+    );
+}
+///----------------------------------------------------------------------------
 /// Receive response
 ///----------------------------------------------------------------------------
 template <typename Recver>
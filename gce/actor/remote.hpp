@@ -128,6 +128,10 @@ inline void connect(
   )
 {
   detail::cache_pool* user = sire.get_cache_pool();
+  if (opt.pool_ != match_nil || sire.get_context()->get_attributes().io_pool_ != match_nil)
+  {
+    user = sire.get_context()->select_net_cache_pool(opt.pool_, user);
+  }
   detail::connect(sire, user, target, ep, target_is_router, opt, remote_func_list);
   ctxid_pair_t ctxid_pr;
   aid_t skt = recv(sire, detail::msg_new_conn, ctxid_pr);
@@ -147,7 +151,8 @@ inline void connect(
   remote_func_list_t const& remote_func_list = remote_func_list_t()
   )
 {
-  detail::cache_pool* user = sire.get_context()->select_cache_pool();
+  detail::cache_pool* user =
+    sire.get_context()->select_net_cache_pool(opt.pool_, sire.get_cache_pool());
   detail::connect(sire, user, target, ep, target_is_router, opt, remote_func_list);
   ctxid_pair_t ctxid_pr;
   aid_t skt = recv(sire, detail::msg_new_conn, ctxid_pr);
@@ -166,7 +171,8 @@ inline void connect(
   remote_func_list_t const& remote_func_list = remote_func_list_t()
   )
 {
-  detail::cache_pool* user = sire.get_context()->select_cache_pool();
+  detail::cache_pool* user =
+    sire.get_context()->select_net_cache_pool(opt.pool_, sire.get_cache_pool());
   detail::connect(sire, user, target, ep, target_is_router, opt, remote_func_list);
 
   match mach;
@@ -192,7 +198,8 @@ inline void bind(
   net_option opt = net_option()
   )
 {
-  detail::cache_pool* user = sire.get_context()->select_cache_pool();
+  detail::cache_pool* user =
+    sire.get_context()->select_net_cache_pool(opt.pool_, sire.get_cache_pool());
   user->get_strand().post(
     boost::bind(
       &detail::bind_impl,
@@ -214,7 +221,8 @@ inline void bind(
   net_option opt = net_option()
   )
 {
-  detail::cache_pool* user = sire.get_context()->select_cache_pool();
+  detail::cache_pool* user =
+    sire.get_context()->select_net_cache_pool(opt.pool_, sire.get_cache_pool());
   user->get_strand().post(
     boost::bind(
       &detail::bind_impl,
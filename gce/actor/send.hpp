@@ -15,15 +15,17 @@
 #include <gce/actor/actor_id.hpp>
 #include <gce/actor/service_id.hpp>
 #include <gce/actor/message.hpp>
+#include <boost/move/utility.hpp>
 
 namespace gce
 {
 namespace detail
 {
+/// m is built for this call only, so hand it over instead of copying.
 template <typename Sender, typename Recver>
 inline void send(Sender& sender, Recver recver, message& m)
 {
-  sender.send(recver, m);
+  sender.send(recver, boost::move(m));
 }
 
 template <typename Sender, typename Recver>
@@ -35,7 +37,7 @@ inline response_t request(Sender& sender, Recver recver, message& m)
 template <typename Sender>
 inline void reply(Sender& sender, aid_t recver, message& m)
 {
-  sender.reply(recver, m);
+  sender.reply(recver, boost::move(m));
 }
 }
 ///----------------------------------------------------------------------------
@@ -119,6 +121,16 @@ inline response_t request(Sender& sender, Recver recver)
   return detail::request(sender, recver, m);
 }
 ///----------------------------------------------------------------------------
+/// With a deadline tmo from now; once passed, recver drops the request
+/// unprocessed, so use the same tmo to recv its response.
+template <typename Sender, typename Recver>
+inline response_t request(
+  Sender& sender, Recver recver, message const& m, duration_t tmo
+  )
+{
+  return sender.request(recver, m, tmo);
+}
+///----------------------------------------------------------------------------
 template <typename Sender, typename Recver>
 inline response_t request(Sender& sender, Recver recver, match_t type)
 {
@@ -251,6 +263,35 @@ inline void reply(
   detail::reply(sender, recver, m);
 }
 ///----------------------------------------------------------------------------
+/// Typed, local recvers get obj itself and no amsg encoding/decoding
+/// happens unless the msg goes through a socket; recv it with >> as usual.
+///----------------------------------------------------------------------------
+template <typename Sender, typename Recver, typename T>
+inline void send_typed(Sender& sender, Recver recver, match_t type, T const& obj)
+{
+  message m(type);
+  m.set_object(obj);
+  detail::send(sender, recver, m);
+}
+///----------------------------------------------------------------------------
+template <typename Sender, typename Recver, typename T>
+inline response_t request_typed(
+  Sender& sender, Recver recver, match_t type, T const& obj
+  )
+{
+  message m(type);
+  m.set_object(obj);
+  return detail::request(sender, recver, m);
+}
+///----------------------------------------------------------------------------
+template <typename Sender, typename T>
+inline void reply_typed(Sender& sender, aid_t recver, match_t type, T const& obj)
+{
+  message m(type);
+  m.set_object(obj);
+  detail::reply(sender, recver, m);
+}
+///----------------------------------------------------------------------------
 }
 
 #endif /// GCE_ACTOR_SEND_HPP
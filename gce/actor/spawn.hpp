@@ -63,7 +63,7 @@ inline cache_pool* select_cache_pool(Sire& sire, bool sync_sire)
   }
   else
   {
-    user = sire.get_context()->select_cache_pool();
+    user = sire.get_context()->select_cache_pool(sire.get_cache_pool());
   }
   return user;
 }
@@ -409,7 +409,7 @@ inline aid_t spawn(
   std::size_t stack_size = default_stacksize()
   )
 {
-  detail::cache_pool* user = sire.get_context()->select_cache_pool();
+  detail::cache_pool* user = sire.get_context()->select_cache_pool(sire.get_cache_pool());
   return detail::spawn(stackful(), sire, f, user, type, stack_size);
 }
 
@@ -420,7 +420,31 @@ inline aid_t spawn(
   std::size_t stack_size = default_stacksize()
   )
 {
-  detail::cache_pool* user = sire.get_context()->select_cache_pool();
+  detail::cache_pool* user = sire.get_context()->select_cache_pool(sire.get_cache_pool());
+  return detail::spawn(Tag(), sire, f, user, type, stack_size);
+}
+///------------------------------------------------------------------------------
+/// Spawn a actor on given named pool, using NONE coroutine_stackless_actor
+///------------------------------------------------------------------------------
+template <typename Sire, typename F>
+inline aid_t spawn(
+  Sire& sire, F f, pool_name pool,
+  link_type type = no_link,
+  std::size_t stack_size = default_stacksize()
+  )
+{
+  detail::cache_pool* user = sire.get_context()->select_cache_pool(pool);
+  return detail::spawn(stackful(), sire, f, user, type, stack_size);
+}
+
+template <typename Tag, typename Sire, typename F>
+inline aid_t spawn(
+  Sire& sire, F f, pool_name pool,
+  link_type type = no_link,
+  std::size_t stack_size = default_stacksize()
+  )
+{
+  detail::cache_pool* user = sire.get_context()->select_cache_pool(pool);
   return detail::spawn(Tag(), sire, f, user, type, stack_size);
 }
 ///------------------------------------------------------------------------------
@@ -472,6 +496,37 @@ inline void spawn(
     );
 }
 ///------------------------------------------------------------------------------
+/// spawn a actor on given named pool, using coroutine_stackless_actor
+///------------------------------------------------------------------------------
+template <typename F>
+inline void spawn(
+  actor<stackless>& sire, F f, aid_t& aid, pool_name pool,
+  link_type type = no_link,
+  std::size_t stack_size = default_stacksize()
+  )
+{
+  spawn<stackless>(sire, f, aid, pool, type, stack_size);
+}
+
+template <typename Tag, typename F>
+inline void spawn(
+  actor<stackless>& sire, F f, aid_t& aid, pool_name pool,
+  link_type type = no_link,
+  std::size_t stack_size = default_stacksize()
+  )
+{
+  coroutine_stackless_actor& a = sire.get_actor();
+  detail::cache_pool* user = sire.get_context()->select_cache_pool(pool);
+  detail::spawn(
+    Tag(), sire, f, 
+    boost::bind(
+      &coroutine_stackless_actor::spawn_handler, &a, 
+      _1, _2, boost::ref(aid)
+      ), 
+    user, type, stack_size
+    );
+}
+///------------------------------------------------------------------------------
 /// Spawn a thread_mapped_actor
 ///------------------------------------------------------------------------------
 inline actor<threaded> spawn(context& ctx)
@@ -45,8 +45,8 @@ public:
   void relay(aid_t, message&);
   void relay(svcid_t, message&);
 
-  response_t request(aid_t, message const&);
-  response_t request(svcid_t, message const&);
+  response_t request(aid_t, message const&, duration_t tmo = infin);
+  response_t request(svcid_t, message const&, duration_t tmo = infin);
   void reply(aid_t, message const&);
 
   void link(aid_t);
@@ -57,6 +57,16 @@ public:
     response_t, message&,
     duration_t tmo = seconds_t(GCE_DEFAULT_REQUEST_TIMEOUT_SEC)
     );
+
+  /// Append up to max_n matching msgs to batch; block only if there is
+  /// none yet. Return number appended, 0 if timed out.
+  std::size_t recv_batch(msg_batch_t& batch, std::size_t max_n, match const& mach = match());
+
+  /// Move answered ones of pending to batch; block until all (or, if not
+  /// all, any) answered or tmo passed. Return number moved.
+  std::size_t recv_responses(
+    response_list_t& pending, res_batch_t& batch, duration_t tmo, bool all
+    );
   void wait(duration_t);
 
 public:
@@ -80,8 +90,19 @@ private:
   typedef boost::promise<res_optional_t> res_promise_t;
   typedef boost::unique_future<recv_optional_t> recv_future_t;
   typedef boost::unique_future<res_optional_t> res_future_t;
+
+  /// pri_* may be overloaded on rvalues, pick the ones bind copies into.
+  typedef void (base_type::*pri_send_t)(aid_t, message const&, send_hint);
+  typedef void (base_type::*pri_send_svc_t)(svcid_t, message const&, send_hint);
+  typedef void (base_type::*pri_relay_t)(aid_t, message&, send_hint);
+  typedef void (base_type::*pri_relay_svc_t)(svcid_t, message&, send_hint);
   void try_recv(recv_promise_t&, match const&);
+  void try_recv_batch(recv_promise_t&, msg_batch_t&, std::size_t, match const&);
   void try_response(res_promise_t&, response_t, duration_t);
+  void try_recv_responses(
+    res_promise_t&, response_list_t&, res_batch_t&, duration_t, bool
+    );
+  void end_recv_responses();
   void start_recv_timer(duration_t, recv_promise_t&);
   void start_recv_timer(duration_t, res_promise_t&);
   void handle_recv_timeout(errcode_t const&, recv_promise_t&, std::size_t);
@@ -97,6 +118,9 @@ private:
   std::vector<nonblocking_actor*> nonblocking_actor_list_;
   recv_promise_t* recv_p_;
   res_promise_t* res_p_;
+  msg_batch_t* recv_batch_;
+  std::size_t batch_max_;
+  base_type::res_gather res_gather_;
   response_t recving_res_;
   match curr_match_;
   timer_t tmr_;
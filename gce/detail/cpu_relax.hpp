@@ -0,0 +1,36 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_DETAIL_CPU_RELAX_HPP
+#define GCE_DETAIL_CPU_RELAX_HPP
+
+#include <gce/config.hpp>
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
+namespace gce
+{
+namespace detail
+{
+/// Pause instruction for spin loops, lets the sibling hyper-thread run.
+inline void cpu_relax()
+{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+  _mm_pause();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+  __builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+}
+}
+
+#endif /// GCE_DETAIL_CPU_RELAX_HPP
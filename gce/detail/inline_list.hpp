@@ -0,0 +1,136 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#ifndef GCE_DETAIL_INLINE_LIST_HPP
+#define GCE_DETAIL_INLINE_LIST_HPP
+
+#include <gce/config.hpp>
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+
+namespace gce
+{
+namespace detail
+{
+/// A vector keeping its first N elements inline; it only allocates when it
+/// grows past N, so copying or filling a short one never does.
+template <typename T, std::size_t N>
+class inline_list
+{
+public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef T const* const_iterator;
+  typedef T& reference;
+  typedef T const& const_reference;
+  typedef std::size_t size_type;
+
+public:
+  inline_list()
+    : size_(0)
+  {
+  }
+
+  inline_list(std::vector<T> const& other)
+    : size_(0)
+  {
+    append(other.begin(), other.end());
+  }
+
+  inline_list(inline_list const& other)
+    : size_(0)
+  {
+    append(other.begin(), other.end());
+  }
+
+  inline_list& operator=(inline_list const& rhs)
+  {
+    if (this != &rhs)
+    {
+      clear();
+      append(rhs.begin(), rhs.end());
+    }
+    return *this;
+  }
+
+public:
+  inline iterator begin() { return data(); }
+  inline iterator end() { return data() + size_; }
+  inline const_iterator begin() const { return data(); }
+  inline const_iterator end() const { return data() + size_; }
+
+  inline size_type size() const { return size_; }
+  inline bool empty() const { return size_ == 0; }
+  inline reference operator[](size_type i) { return data()[i]; }
+  inline const_reference operator[](size_type i) const { return data()[i]; }
+  inline reference front() { return data()[0]; }
+  inline reference back() { return data()[size_ - 1]; }
+
+  void push_back(T const& t)
+  {
+    if (size_ < N)
+    {
+      inline_[size_] = t;
+    }
+    else
+    {
+      if (size_ == N)
+      {
+        heap_.reserve(N * 2);
+        heap_.assign(inline_, inline_ + N);
+      }
+      heap_.push_back(t);
+    }
+    ++size_;
+  }
+
+  void pop_back()
+  {
+    if (size_ > N)
+    {
+      heap_.pop_back();
+      if (size_ == N + 1)
+      {
+        /// Back inline.
+        std::copy(heap_.begin(), heap_.end(), inline_);
+        heap_.clear();
+      }
+    }
+    --size_;
+  }
+
+  void clear()
+  {
+    heap_.clear();
+    size_ = 0;
+  }
+
+  template <typename InputIterator>
+  void append(InputIterator first, InputIterator last)
+  {
+    for (; first != last; ++first)
+    {
+      push_back(*first);
+    }
+  }
+
+private:
+  inline T* data() { return size_ > N ? &heap_[0] : inline_; }
+  inline T const* data() const { return size_ > N ? &heap_[0] : inline_; }
+
+private:
+  T inline_[N];
+  std::vector<T> heap_;
+  size_type size_;
+};
+}
+}
+
+#endif /// GCE_DETAIL_INLINE_LIST_HPP
@@ -0,0 +1,82 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#include <gce/actor/all.hpp>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+/// Times context construction, first spawn and teardown.
+/// usage: gce_actor_startup [context_num] [thread_num]
+
+void hello(gce::actor<gce::stackful>& self)
+{
+  gce::aid_t sender = gce::recv(self, gce::atom("hello"));
+  gce::send(self, sender, gce::atom("hello"));
+}
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    typedef boost::chrono::steady_clock clock_t;
+    typedef boost::chrono::microseconds usecs_t;
+
+    std::size_t const context_num =
+      (argc > 1 && std::atoi(argv[1]) > 0) ? std::atoi(argv[1]) : 100;
+    gce::attributes attrs;
+    if (argc > 2 && std::atoi(argv[2]) > 0)
+    {
+      attrs.thread_num_ = std::atoi(argv[2]);
+    }
+
+    clock_t::duration ctor_dur = clock_t::duration::zero();
+    clock_t::duration spawn_dur = clock_t::duration::zero();
+    clock_t::duration dtor_dur = clock_t::duration::zero();
+    for (std::size_t i=0; i<context_num; ++i)
+    {
+      clock_t::time_point begin_tp = clock_t::now();
+      gce::context* ctx = new gce::context(attrs);
+      clock_t::time_point ctor_tp = clock_t::now();
+
+      {
+        gce::actor<gce::threaded> base = gce::spawn(*ctx);
+        gce::aid_t aid = gce::spawn(base, boost::bind(&hello, _1));
+        gce::send(base, aid, gce::atom("hello"));
+        gce::recv(base, gce::atom("hello"));
+      }
+      clock_t::time_point spawn_tp = clock_t::now();
+
+      delete ctx;
+      clock_t::time_point end_tp = clock_t::now();
+
+      ctor_dur += ctor_tp - begin_tp;
+      spawn_dur += spawn_tp - ctor_tp;
+      dtor_dur += end_tp - spawn_tp;
+    }
+
+    std::cout << "contexts: " << context_num <<
+      ", threads: " << attrs.thread_num_ << std::endl;
+    std::cout << "ctor avg: " <<
+      boost::chrono::duration_cast<usecs_t>(ctor_dur).count() / context_num <<
+      " us" << std::endl;
+    std::cout << "first spawn avg: " <<
+      boost::chrono::duration_cast<usecs_t>(spawn_dur).count() / context_num <<
+      " us" << std::endl;
+    std::cout << "dtor avg: " <<
+      boost::chrono::duration_cast<usecs_t>(dtor_dur).count() / context_num <<
+      " us" << std::endl;
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+  }
+
+  return 0;
+}
@@ -29,7 +29,10 @@ namespace detail
 {
 ///----------------------------------------------------------------------------
 acceptor::acceptor(cache_pool* user)
-  : basic_actor(&user->get_context(), user, user->get_index())
+  : basic_actor(
+      &user->get_context(), user,
+      user->get_index(), user->per_actor_strand()
+      )
   , stat_(ready)
   , is_router_(false)
 {
@@ -83,11 +86,7 @@ void acceptor::on_free()
 ///----------------------------------------------------------------------------
 void acceptor::on_recv(pack& pk, base_type::send_hint)
 {
-  snd_.dispatch(
-    boost::bind(
-      &acceptor::handle_recv, this, pk
-      )
-    );
+  base_type::push_inbox(pk, base_type::sync);
 }
 ///----------------------------------------------------------------------------
 void send_ret(acceptor* a, aid_t sire)
@@ -100,9 +99,8 @@ void acceptor::run(aid_t sire, std::string const& ep, yield_t yield)
   exit_code_t exc = exit_normal;
   std::string exit_msg("exit normal");
 
-  if (!user_->stopped())
+  if (user_->add_acceptor(this))
   {
-    user_->add_acceptor(this);
 
     try
     {
@@ -123,7 +121,7 @@ void acceptor::run(aid_t sire, std::string const& ep, yield_t yield)
           break;
         }
 
-        cache_pool* user = ctx_->select_cache_pool();
+        cache_pool* user = ctx_->select_net_cache_pool(opt_.pool_, user_);
         user->get_strand().post(
           boost::bind(
             &acceptor::spawn_socket, this, user, prot
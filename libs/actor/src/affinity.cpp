@@ -0,0 +1,85 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#include <gce/actor/detail/affinity.hpp>
+#include <boost/lexical_cast.hpp>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+
+#if BOOST_OS_LINUX
+# include <pthread.h>
+# include <sched.h>
+# include <dirent.h>
+#elif BOOST_OS_WINDOWS
+# include <windows.h>
+#endif
+
+namespace gce
+{
+namespace detail
+{
+///----------------------------------------------------------------------------
+bool set_thread_affinity(std::size_t cpu)
+{
+#if BOOST_OS_LINUX
+  if (cpu >= CPU_SETSIZE)
+  {
+    return false;
+  }
+
+  cpu_set_t cs;
+  CPU_ZERO(&cs);
+  CPU_SET(cpu, &cs);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cs), &cs) == 0;
+#elif BOOST_OS_WINDOWS
+  if (cpu >= sizeof(DWORD_PTR) * 8)
+  {
+    return false;
+  }
+  return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+  return false;
+#endif
+}
+///----------------------------------------------------------------------------
+std::size_t get_cpu_node(std::size_t cpu)
+{
+  std::size_t node = 0;
+#if BOOST_OS_LINUX
+  /// /sys/devices/system/cpu/cpuN/ holds a "nodeM" link to its node.
+  std::string path("/sys/devices/system/cpu/cpu");
+  path += boost::lexical_cast<std::string>(cpu);
+  DIR* dir = opendir(path.c_str());
+  if (dir)
+  {
+    while (dirent* ent = readdir(dir))
+    {
+      char const* name = ent->d_name;
+      if (std::strncmp(name, "node", 4) == 0 && std::isdigit(name[4]))
+      {
+        node = std::strtoul(name + 4, 0, 10);
+        break;
+      }
+    }
+    closedir(dir);
+  }
+#elif BOOST_OS_WINDOWS && _WIN32_WINNT >= 0x0502
+  UCHAR n = 0;
+  if (cpu < 256 && GetNumaProcessorNode((UCHAR)cpu, &n) && n != 0xFF)
+  {
+    node = n;
+  }
+#endif
+  return node;
+}
+///----------------------------------------------------------------------------
+}
+}
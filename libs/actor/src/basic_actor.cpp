@@ -1,36 +1,57 @@
-﻿///
-/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
-///
-/// Distributed under the Boost Software License, Version 1.0. (See accompanying
-/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
-///
-/// See https://github.com/nousxiong/gce for latest version.
-///
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
 
 #include <gce/actor/basic_actor.hpp>
 #include <gce/actor/context.hpp>
 #include <gce/actor/detail/cache_pool.hpp>
 #include <gce/actor/detail/pack.hpp>
 #include <gce/detail/scope.hpp>
+#include <boost/utility/in_place_factory.hpp>
 #include <boost/variant/get.hpp>
+#include <boost/move/utility.hpp>
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
 
 namespace gce
 {
 ///----------------------------------------------------------------------------
-basic_actor::basic_actor(context* ctx, detail::cache_pool* user, std::size_t cache_queue_index)
+basic_actor::basic_actor(
+  context* ctx, detail::cache_pool* user,
+  std::size_t cache_queue_index, bool own_strand
+  )
   : ctx_(ctx)
   , user_(user)
-  , snd_(user_->get_strand())
-  , mb_(ctx_->get_attributes().max_cache_match_size_)
+  , snd_(select_strand(own_strand))
+  , mb_(
+      ctx_->get_match_index(),
+      ctx_->get_attributes().max_cache_match_size_,
+      user_->get_shed_num()
+      )
   , ctxid_(ctx_->get_attributes().id_)
   , timestamp_(ctx_->get_timestamp())
   , cache_queue_index_(cache_queue_index)
+  , wdg_(ctx_->get_watchdog())
   , chain_(true)
+  , msg_budget_(ctx_->get_attributes().msg_budget_)
+  , time_budget_(ctx_->get_attributes().time_budget_)
+  , track_fairness_(ctx_->get_attributes().track_fairness_)
+  , run_num_(0)
+  , preempted_(false)
+  , running_(false)
+  , count_on_pop_(false)
+  , unpark_posted_(false)
+  , overloaded_(false)
   , req_id_(0)
 {
   aid_ = aid_t(ctxid_, timestamp_, this, 0);
-}
+}
 ///----------------------------------------------------------------------------
 basic_actor::~basic_actor()
 {
@@ -38,118 +59,44 @@ basic_actor::~basic_actor()
 ///----------------------------------------------------------------------------
 void basic_actor::pri_send(aid_t recver, message const& m, send_hint hint)
 {
-  aid_t target = filter_aid(recver);
-  if (target)
-  {
-    detail::pack pk;
-    pk.tag_ = get_aid();
-    pk.recver_ = recver;
-    pk.skt_ = target;
-    pk.msg_ = m;
-
-    if (!chain_)
-    {
-      hint = async;
-    }
-    send(target, pk, hint);
-  }
+  detail::pack pk;
+  pk.msg_ = m;
+  route(recver, pk, hint);
 }
 ///----------------------------------------------------------------------------
 void basic_actor::pri_send_svc(svcid_t recver, message const& m, send_hint hint)
 {
-  aid_t target = filter_svcid(recver);
-  if (target)
-  {
-    detail::pack pk;
-    pk.tag_ = get_aid();
-    if (recver.ctxid_ == ctxid_nil || recver.ctxid_ == ctxid_)
-    {
-      /// is local none socket actor
-      pk.recver_ = target;
-    }
-    pk.svc_ = recver;
-    pk.skt_ = target;
-    pk.msg_ = m;
-
-    if (!chain_)
-    {
-      hint = async;
-    }
-    send(target, pk, hint);
-  }
+  detail::pack pk;
+  pk.msg_ = m;
+  route_svc(recver, pk, hint);
 }
 ///----------------------------------------------------------------------------
 void basic_actor::pri_relay(aid_t recver, message& m, send_hint hint)
 {
-  aid_t target = filter_aid(recver);
-  if (target)
-  {
-    detail::pack pk;
-    if (m.req_.valid())
-    {
-      pk.tag_ = m.req_;
-      m.req_ = detail::request_t();
-    }
-    else
-    {
-      pk.tag_ = get_aid();
-    }
-    pk.recver_ = recver;
-    pk.skt_ = target;
-    pk.msg_ = m;
-
-    if (!chain_)
-    {
-      hint = async;
-    }
-    send(target, pk, hint);
-  }
-  else if (m.req_.valid())
-  {
-    /// reply actor exit msg
-    response_t res(m.req_.get_id(), recver);
-    send_already_exited(m.req_.get_aid(), res);
-  }
+  detail::request_t req = m.req_;
+  m.req_ = detail::request_t();
+  detail::pack pk;
+  pk.msg_ = m;
+  route_relay(recver, pk, req, hint);
 }
 ///----------------------------------------------------------------------------
 void basic_actor::pri_relay_svc(svcid_t recver, message& m, send_hint hint)
 {
-  aid_t target = filter_svcid(recver);
-  if (target)
-  {
-    detail::pack pk;
-    if (m.req_.valid())
-    {
-      pk.tag_ = m.req_;
-      m.req_ = detail::request_t();
-    }
-    else
-    {
-      pk.tag_ = get_aid();
-    }
-
-    if (recver.ctxid_ == ctxid_nil || recver.ctxid_ == ctxid_)
-    {
-      /// is local none socket actor
-      pk.recver_ = target;
-    }
-    pk.svc_ = recver;
-    pk.skt_ = target;
-    pk.msg_ = m;
-
-    if (!chain_)
-    {
-      hint = async;
-    }
-    send(target, pk, hint);
-  }
+  detail::request_t req = m.req_;
+  m.req_ = detail::request_t();
+  detail::pack pk;
+  pk.msg_ = m;
+  route_relay_svc(recver, pk, req, hint);
 }
 ///----------------------------------------------------------------------------
-void basic_actor::pri_request(response_t res, aid_t recver, message const& m, send_hint hint)
+void basic_actor::pri_request(
+  response_t res, aid_t recver, message const& m,
+  duration_t tmo, send_hint hint
+  )
 {
   aid_t target = filter_aid(recver);
   aid_t sender = get_aid();
-  detail::request_t req(res.get_id(), sender);
+  detail::request_t req(res.get_id(), sender, tmo);
   if (target)
   {
     detail::pack pk;
@@ -172,11 +119,14 @@ void basic_actor::pri_request(response_t res, aid_t recver, message const& m, se
   }
 }
 ///----------------------------------------------------------------------------
-void basic_actor::pri_request_svc(response_t res, svcid_t recver, message const& m, send_hint hint)
+void basic_actor::pri_request_svc(
+  response_t res, svcid_t recver, message const& m,
+  duration_t tmo, send_hint hint
+  )
 {
   aid_t target = filter_svcid(recver);
   aid_t sender = get_aid();
-  detail::request_t req(res.get_id(), sender);
+  detail::request_t req(res.get_id(), sender, tmo);
   if (target)
   {
     detail::pack pk;
@@ -200,32 +150,53 @@ void basic_actor::pri_request_svc(response_t res, svcid_t recver, message const&
 ///----------------------------------------------------------------------------
 void basic_actor::pri_reply(aid_t recver, message const& m, send_hint hint)
 {
-  aid_t target = filter_aid(recver);
-  if (target)
-  {
-    detail::request_t req;
-    detail::pack pk;
-    if (mb_.pop(recver, req))
-    {
-      response_t res(req.get_id(), get_aid());
-      pk.tag_ = res;
-    }
-    else
-    {
-      pk.tag_ = get_aid();
-    }
-    pk.recver_ = recver;
-    pk.skt_ = target;
-    pk.msg_ = m;
-
-    if (!chain_)
-    {
-      hint = async;
-    }
-    send(target, pk, hint);
-  }
+  detail::pack pk;
+  pk.msg_ = m;
+  route_reply(recver, pk, hint);
 }
 ///----------------------------------------------------------------------------
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+void basic_actor::pri_send(aid_t recver, message&& m, send_hint hint)
+{
+  detail::pack pk;
+  pk.msg_ = std::move(m);
+  route(recver, pk, hint);
+}
+///----------------------------------------------------------------------------
+void basic_actor::pri_send_svc(svcid_t recver, message&& m, send_hint hint)
+{
+  detail::pack pk;
+  pk.msg_ = std::move(m);
+  route_svc(recver, pk, hint);
+}
+///----------------------------------------------------------------------------
+void basic_actor::pri_relay(aid_t recver, message&& m, send_hint hint)
+{
+  detail::request_t req = m.req_;
+  m.req_ = detail::request_t();
+  detail::pack pk;
+  pk.msg_ = std::move(m);
+  route_relay(recver, pk, req, hint);
+}
+///----------------------------------------------------------------------------
+void basic_actor::pri_relay_svc(svcid_t recver, message&& m, send_hint hint)
+{
+  detail::request_t req = m.req_;
+  m.req_ = detail::request_t();
+  detail::pack pk;
+  pk.msg_ = std::move(m);
+  route_relay_svc(recver, pk, req, hint);
+}
+///----------------------------------------------------------------------------
+void basic_actor::pri_reply(aid_t recver, message&& m, send_hint hint)
+{
+  detail::pack pk;
+  pk.msg_ = std::move(m);
+  route_reply(recver, pk, hint);
+}
+///----------------------------------------------------------------------------
+#endif
+///----------------------------------------------------------------------------
 void basic_actor::pri_link(aid_t target, send_hint hint)
 {
   link(detail::link_t(linked, target), hint, user_);
@@ -267,6 +238,9 @@ void basic_actor::pri_spawn(
 ///----------------------------------------------------------------------------
 void basic_actor::on_free()
 {
+  mb_limit_ = mailbox_limit();
+  overloaded_ = false;
+  parked_list_.clear();
   mb_.clear();
   link_list_.clear();
   monitor_list_.clear();
@@ -374,7 +348,7 @@ void basic_actor::send_already_exited(aid_t recver, aid_t sender)
     pk.tag_ = sender;
     pk.recver_ = recver;
     pk.skt_ = target;
-    pk.msg_ = m;
+    pk.msg_ = boost::move(m);
     pk.is_err_ret_ = true;
 
     send(target, pk, async);
@@ -382,19 +356,25 @@ void basic_actor::send_already_exited(aid_t recver, aid_t sender)
 }
 ///----------------------------------------------------------------------------
 void basic_actor::send_already_exited(aid_t recver, response_t res)
+{
+  send_exit_ret(recver, res, exit_already, "already exited");
+}
+///----------------------------------------------------------------------------
+void basic_actor::send_exit_ret(
+  aid_t recver, response_t res, exit_code_t ec, std::string const& exit_msg
+  )
 {
   aid_t target = filter_aid(recver);
   if (target)
   {
     message m(exit);
-    std::string exit_msg("already exited");
-    m << exit_already << exit_msg;
+    m << ec << exit_msg;
 
     detail::pack pk;
     pk.tag_ = res;
     pk.recver_ = recver;
     pk.skt_ = target;
-    pk.msg_ = m;
+    pk.msg_ = boost::move(m);
     pk.is_err_ret_ = true;
 
     send(target, pk, async);
@@ -407,6 +387,462 @@ void basic_actor::send(aid_t const& recver, detail::pack& pk, send_hint hint)
   recver.get_actor_ptr(ctxid_, timestamp_)->on_recv(pk, hint);
 }
 ///----------------------------------------------------------------------------
+void basic_actor::push_inbox(detail::pack& pk, send_hint hint)
+{
+  if (inbox_.push(pk))
+  {
+    user_->add_load();
+    if (hint == sync)
+    {
+      snd_.dispatch(boost::bind(&basic_actor::handle_inbox, this));
+    }
+    else
+    {
+      post_inbox();
+    }
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::handle_inbox()
+{
+  /// If a producer is still linking its pack or handle_recv throws, the
+  /// inbox stays scheduled, so come back later for the rest.
+  detail::scope scp(boost::bind(&basic_actor::post_inbox, this));
+  begin_activation();
+  bool done =
+    inbox_.drain(
+      boost::bind(&basic_actor::handle_pack, this, _1),
+      boost::bind(&basic_actor::stop_drain, this)
+      );
+  end_activation();
+  if (done)
+  {
+    scp.reset();
+    user_->sub_load();
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::handle_pack(detail::pack& pk)
+{
+  if (!parked_list_.empty() && bounded(pk))
+  {
+    /// Behind the held back ones, to keep user msgs in order.
+    park(pk);
+    return;
+  }
+
+  detail::watchdog::scope scp(wdg_, aid_, pk.msg_.get_type());
+  if (mb_limit_.capacity_ == 0 || admit(pk))
+  {
+    handle_recv(pk);
+    check_high_water();
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::handle_parked()
+{
+  unpark_posted_ = false;
+  while (!parked_list_.empty())
+  {
+    if (
+      mb_limit_.capacity_ > 0 &&
+      mb_limit_.policy_ == overflow_block &&
+      mb_.size() >= mb_limit_.capacity_
+      )
+    {
+      break;
+    }
+
+    detail::pack pk(boost::move(parked_list_.front()));
+    parked_list_.pop_front();
+    detail::watchdog::scope scp(wdg_, aid_, pk.msg_.get_type());
+    if (mb_limit_.capacity_ == 0 || admit(pk))
+    {
+      handle_recv(pk);
+      check_high_water();
+    }
+  }
+}
+///----------------------------------------------------------------------------
+bool basic_actor::stop_drain()
+{
+  /// A pack only queued in mb_ is counted when popped.
+  return count_on_pop_ ? preempted_ : consume_budget();
+}
+///----------------------------------------------------------------------------
+void basic_actor::begin_activation()
+{
+  run_num_ = 0;
+  preempted_ = false;
+  running_ = true;
+  if (time_budget_ > zero || track_fairness_)
+  {
+    run_begin_ = boost::chrono::steady_clock::now();
+  }
+}
+///----------------------------------------------------------------------------
+bool basic_actor::consume_budget()
+{
+  if (preempted_)
+  {
+    return true;
+  }
+
+  if (msg_budget_ > 0 && ++run_num_ >= msg_budget_)
+  {
+    preempted_ = true;
+  }
+  else if (
+    time_budget_ > zero &&
+    boost::chrono::steady_clock::now() - run_begin_ >= time_budget_
+    )
+  {
+    preempted_ = true;
+  }
+  return preempted_;
+}
+///----------------------------------------------------------------------------
+void basic_actor::end_activation()
+{
+  /// A stackful actor may end its activation inside handle_inbox's.
+  if (track_fairness_ && running_)
+  {
+    running_ = false;
+    user_->add_activation(
+      boost::chrono::duration_cast<duration_t>(
+        boost::chrono::steady_clock::now() - run_begin_
+        ),
+      preempted_
+      );
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::post_inbox()
+{
+  snd_.post(boost::bind(&basic_actor::handle_inbox, this));
+}
+///----------------------------------------------------------------------------
+strand_t& basic_actor::select_strand(bool own_strand)
+{
+  if (own_strand)
+  {
+    own_snd_ = boost::in_place(boost::ref(user_->get_io_service()));
+    return *own_snd_;
+  }
+  return user_->get_strand();
+}
+///----------------------------------------------------------------------------
+match const& basic_actor::filter_match(match const& mach, match& tmp)
+{
+  if (!mach.svc_ || mach.from_)
+  {
+    return mach;
+  }
+
+  svcid_t const& svc = mach.svc_;
+  if (svc.ctxid_ == ctxid_nil || svc.ctxid_ == ctxid_)
+  {
+    tmp = mach;
+    tmp.from_ = user_->find_service(svc.name_);
+    if (!tmp.from_)
+    {
+      /// Not registered, only its exit msgs could match.
+      tmp.svc_.ctxid_ = ctxid_nil;
+    }
+    return tmp;
+  }
+  return mach;
+}
+///----------------------------------------------------------------------------
+bool basic_actor::pop_msg(detail::recv_t& rcv, message& msg, match const& mach)
+{
+  if (!mb_.pop(rcv, msg, mach))
+  {
+    return false;
+  }
+  on_pop();
+  return true;
+}
+///----------------------------------------------------------------------------
+bool basic_actor::pop_msg(detail::recv_t& rcv, message& msg, match_list_t const& match_list)
+{
+  if (!mb_.pop(rcv, msg, match_list))
+  {
+    return false;
+  }
+  on_pop();
+  return true;
+}
+///----------------------------------------------------------------------------
+std::size_t basic_actor::pop_batch(
+  msg_batch_t& batch, std::size_t max_n, match const& mach
+  )
+{
+  match tmp;
+  match const& filter = filter_match(mach, tmp);
+
+  std::size_t n = 0;
+  detail::recv_t rcv;
+  for (; n < max_n; ++n)
+  {
+    batch.push_back(msg_batch_t::value_type());
+    msg_batch_t::value_type& item = batch.back();
+    if (!pop_msg(rcv, item.second, filter))
+    {
+      batch.pop_back();
+      break;
+    }
+    item.first = get_sender(rcv, item.second);
+  }
+  return n;
+}
+///----------------------------------------------------------------------------
+std::size_t basic_actor::pop_responses(
+  response_list_t& pending, res_batch_t& batch
+  )
+{
+  std::size_t n = 0;
+  std::size_t last = 0;
+  for (std::size_t i=0; i<pending.size(); ++i)
+  {
+    batch.push_back(res_batch_t::value_type(pending[i], message()));
+    res_batch_t::value_type& item = batch.back();
+    if (mb_.pop(item.first, item.second))
+    {
+      ++n;
+    }
+    else
+    {
+      batch.pop_back();
+      pending[last++] = pending[i];
+    }
+  }
+  pending.resize(last);
+  return n;
+}
+///----------------------------------------------------------------------------
+std::size_t basic_actor::pop_response(res_gather& gather, response_t const& res)
+{
+  if (!gather.id_list_.find(res.get_id()))
+  {
+    return 0;
+  }
+
+  gather.batch_->push_back(res_batch_t::value_type(res, message()));
+  res_batch_t::value_type& item = gather.batch_->back();
+  if (!mb_.pop(item.first, item.second))
+  {
+    gather.batch_->pop_back();
+    return 0;
+  }
+  gather.id_list_.erase(res.get_id());
+  return 1;
+}
+///----------------------------------------------------------------------------
+std::size_t basic_actor::pop_responses(res_gather& gather)
+{
+  std::size_t n = 0;
+  BOOST_FOREACH(response_t const& res, *gather.pending_)
+  {
+    if (!gather.id_list_.find(res.get_id()))
+    {
+      continue;
+    }
+
+    gather.batch_->push_back(res_batch_t::value_type(res, message()));
+    res_batch_t::value_type& item = gather.batch_->back();
+    if (mb_.pop(item.first, item.second))
+    {
+      gather.id_list_.erase(res.get_id());
+      ++n;
+    }
+    else
+    {
+      gather.batch_->pop_back();
+    }
+  }
+  return n;
+}
+///----------------------------------------------------------------------------
+aid_t basic_actor::get_sender(detail::recv_t& rcv, message& msg)
+{
+  aid_t sender;
+  if (aid_t* aid = boost::get<aid_t>(&rcv))
+  {
+    sender = *aid;
+  }
+  else if (detail::request_t* req = boost::get<detail::request_t>(&rcv))
+  {
+    sender = req->get_aid();
+    msg.req_ = *req;
+  }
+  else if (detail::exit_t* ex = boost::get<detail::exit_t>(&rcv))
+  {
+    sender = ex->get_aid();
+  }
+  return sender;
+}
+///----------------------------------------------------------------------------
+void basic_actor::on_pop()
+{
+  if (mb_limit_.capacity_ > 0)
+  {
+    if (mb_.size() < mb_limit_.capacity_)
+    {
+      unpark();
+    }
+
+    if (overloaded_ && mb_.size() <= mb_limit_.high_water_ / 2)
+    {
+      overloaded_ = false;
+    }
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::set_mailbox_limit(mailbox_limit const& limit)
+{
+  snd_.dispatch(boost::bind(&basic_actor::pri_set_mailbox_limit, this, limit));
+}
+///----------------------------------------------------------------------------
+void basic_actor::pri_set_mailbox_limit(mailbox_limit limit)
+{
+  mb_limit_ = limit;
+  overloaded_ = false;
+  if (limit.capacity_ == 0 || mb_.size() < limit.capacity_)
+  {
+    unpark();
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::discard(response_list_t const& pending)
+{
+  if (!pending.empty())
+  {
+    snd_.dispatch(boost::bind(&basic_actor::pri_discard, this, pending));
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::pri_discard(response_list_t pending)
+{
+  BOOST_FOREACH(response_t const& res, pending)
+  {
+    mb_.discard(res);
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::unpark()
+{
+  /// Not from inside pop_msg, the held back packs may be matched by it.
+  if (!parked_list_.empty() && !unpark_posted_)
+  {
+    unpark_posted_ = true;
+    snd_.post(boost::bind(&basic_actor::handle_parked, this));
+  }
+}
+///----------------------------------------------------------------------------
+bool basic_actor::bounded(detail::pack const& pk) const
+{
+  /// Only user msgs are bounded; a sender's exit msg comes tagged with aid.
+  return
+    (boost::get<aid_t>(&pk.tag_) || boost::get<detail::request_t>(&pk.tag_)) &&
+    pk.msg_.get_type() != exit &&
+    check(pk.recver_, ctxid_, timestamp_);
+}
+///----------------------------------------------------------------------------
+bool basic_actor::admit(detail::pack& pk)
+{
+  if (!bounded(pk) || mb_.size() < mb_limit_.capacity_)
+  {
+    return true;
+  }
+
+  detail::recv_t rcv = get_recv(pk);
+  switch (mb_limit_.policy_)
+  {
+  case overflow_drop_oldest:
+    {
+      message msg;
+      if (mb_.drop_oldest(rcv, msg))
+      {
+        /// Only user msgs are evicted, whatever lane an exit was put in.
+        BOOST_ASSERT(!boost::get<detail::exit_t>(&rcv) && msg.get_type() != exit);
+        drop(rcv, msg, false);
+        return true;
+      }
+      drop(rcv, pk.msg_, false);
+    }
+    break;
+  case overflow_reject:
+    drop(rcv, pk.msg_, true);
+    break;
+  case overflow_block:
+    park(pk);
+    break;
+  default:
+    drop(rcv, pk.msg_, false);
+    break;
+  }
+  return false;
+}
+///----------------------------------------------------------------------------
+void basic_actor::park(detail::pack& pk)
+{
+  /// At most capacity_ held back; past that, reject for backpressure.
+  if (
+    mb_limit_.policy_ == overflow_block &&
+    mb_limit_.capacity_ > 0 &&
+    parked_list_.size() >= mb_limit_.capacity_
+    )
+  {
+    drop(get_recv(pk), pk.msg_, true);
+  }
+  else
+  {
+    parked_list_.push_back(boost::move(pk));
+  }
+}
+///----------------------------------------------------------------------------
+detail::recv_t basic_actor::get_recv(detail::pack const& pk)
+{
+  BOOST_ASSERT(boost::get<aid_t>(&pk.tag_) || boost::get<detail::request_t>(&pk.tag_));
+  if (aid_t const* aid = boost::get<aid_t>(&pk.tag_))
+  {
+    return *aid;
+  }
+  return boost::get<detail::request_t>(pk.tag_);
+}
+///----------------------------------------------------------------------------
+void basic_actor::drop(detail::recv_t const& rcv, message const& msg, bool notify_sender)
+{
+  if (detail::request_t const* req = boost::get<detail::request_t>(&rcv))
+  {
+    response_t res(req->get_id(), get_aid());
+    send_exit_ret(req->get_aid(), res, exit_overflow, "mailbox overflow");
+  }
+  else if (notify_sender)
+  {
+    aid_t const* sender = boost::get<aid_t>(&rcv);
+    BOOST_ASSERT(sender);
+    message m(overflow);
+    m << get_aid() << msg.get_type();
+    pri_send(*sender, m, async);
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::check_high_water()
+{
+  if (
+    !overloaded_ && mb_limit_.alarm_ &&
+    mb_limit_.capacity_ > 0 && mb_.size() >= mb_limit_.high_water_
+    )
+  {
+    overloaded_ = true;
+    message m(overload);
+    m << get_aid() << (boost::uint64_t)mb_.size();
+    pri_send(mb_limit_.alarm_, m, async);
+  }
+}
+///----------------------------------------------------------------------------
 aid_t basic_actor::filter_aid(aid_t const& src)
 {
   aid_t target;
@@ -441,4 +877,133 @@ aid_t basic_actor::filter_svcid(svcid_t const& src)
   return target;
 }
 ///----------------------------------------------------------------------------
+void basic_actor::route(aid_t recver, detail::pack& pk, send_hint hint)
+{
+  aid_t target = filter_aid(recver);
+  if (target)
+  {
+    pk.tag_ = get_aid();
+    pk.recver_ = recver;
+    pk.skt_ = target;
+
+    if (!chain_)
+    {
+      hint = async;
+    }
+    send(target, pk, hint);
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::route_svc(svcid_t recver, detail::pack& pk, send_hint hint)
+{
+  aid_t target = filter_svcid(recver);
+  if (target)
+  {
+    pk.tag_ = get_aid();
+    if (recver.ctxid_ == ctxid_nil || recver.ctxid_ == ctxid_)
+    {
+      /// is local none socket actor
+      pk.recver_ = target;
+    }
+    pk.svc_ = recver;
+    pk.skt_ = target;
+
+    if (!chain_)
+    {
+      hint = async;
+    }
+    send(target, pk, hint);
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::route_relay(
+  aid_t recver, detail::pack& pk, detail::request_t req, send_hint hint
+  )
+{
+  aid_t target = filter_aid(recver);
+  if (target)
+  {
+    if (req.valid())
+    {
+      pk.tag_ = req;
+    }
+    else
+    {
+      pk.tag_ = get_aid();
+    }
+    pk.recver_ = recver;
+    pk.skt_ = target;
+
+    if (!chain_)
+    {
+      hint = async;
+    }
+    send(target, pk, hint);
+  }
+  else if (req.valid())
+  {
+    /// reply actor exit msg
+    response_t res(req.get_id(), recver);
+    send_already_exited(req.get_aid(), res);
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::route_relay_svc(
+  svcid_t recver, detail::pack& pk, detail::request_t req, send_hint hint
+  )
+{
+  aid_t target = filter_svcid(recver);
+  if (target)
+  {
+    if (req.valid())
+    {
+      pk.tag_ = req;
+    }
+    else
+    {
+      pk.tag_ = get_aid();
+    }
+
+    if (recver.ctxid_ == ctxid_nil || recver.ctxid_ == ctxid_)
+    {
+      /// is local none socket actor
+      pk.recver_ = target;
+    }
+    pk.svc_ = recver;
+    pk.skt_ = target;
+
+    if (!chain_)
+    {
+      hint = async;
+    }
+    send(target, pk, hint);
+  }
+}
+///----------------------------------------------------------------------------
+void basic_actor::route_reply(aid_t recver, detail::pack& pk, send_hint hint)
+{
+  aid_t target = filter_aid(recver);
+  if (target)
+  {
+    detail::request_t req;
+    if (mb_.pop(recver, req))
+    {
+      response_t res(req.get_id(), get_aid());
+      pk.tag_ = res;
+    }
+    else
+    {
+      pk.tag_ = get_aid();
+    }
+    pk.recver_ = recver;
+    pk.skt_ = target;
+
+    if (!chain_)
+    {
+      hint = async;
+    }
+    send(target, pk, hint);
+  }
+}
+///----------------------------------------------------------------------------
 }
@@ -0,0 +1,385 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#include <gce/actor/detail/buffer_pool.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/noncopyable.hpp>
+#include <new>
+#include <cstdlib>
+
+namespace gce
+{
+namespace detail
+{
+namespace
+{
+struct thread_cache;
+
+struct block
+{
+  thread_cache* owner_;
+  std::size_t cls_;
+  block* next_;
+  buffer_pool::merge_t merge_;
+};
+
+/// Keep the payload 16 bytes aligned.
+static std::size_t const header_size = (sizeof(block) + 15) & ~(std::size_t)15;
+static std::size_t const min_class_size = 256;
+static std::size_t const class_num = 24;
+static std::size_t const cls_nil = static_cast<std::size_t>(-1);
+
+/// Marks the remote and posted lists of a cache whose thread has exited.
+static block closed_tag;
+
+inline std::size_t class_size(std::size_t cls)
+{
+  return min_class_size << cls;
+}
+
+inline std::size_t get_class(std::size_t size)
+{
+  std::size_t cls = 0;
+  while (cls < class_num && class_size(cls) < size)
+  {
+    ++cls;
+  }
+  return
+    cls < class_num && class_size(cls) <= GCE_BUFFER_POOL_MAX_SIZE ?
+    cls : cls_nil;
+}
+
+inline block* make_block(std::size_t size)
+{
+  block* blk = (block*)std::malloc(header_size + size);
+  if (!blk)
+  {
+    throw std::bad_alloc();
+  }
+  return blk;
+}
+
+inline byte_t* get_data(block* blk)
+{
+  return (byte_t*)blk + header_size;
+}
+
+inline block* get_block(byte_t* data)
+{
+  return (block*)(data - header_size);
+}
+
+struct thread_cache
+  : private boost::noncopyable
+{
+  thread_cache()
+    : owned_(1)
+    , remote_(0)
+    , posted_(0)
+    , biased_(false)
+  {
+    for (std::size_t i=0; i<class_num; ++i)
+    {
+      free_list_[i] = 0;
+      free_num_[i] = 0;
+    }
+  }
+
+  /// Owner thread only.
+  block* get(std::size_t cls)
+  {
+    block* blk = free_list_[cls];
+    if (!blk && remote_.load(boost::memory_order_relaxed))
+    {
+      take_remote();
+      blk = free_list_[cls];
+    }
+
+    if (blk)
+    {
+      free_list_[cls] = blk->next_;
+      --free_num_[cls];
+    }
+    else
+    {
+      blk = make_block(class_size(cls));
+      blk->owner_ = this;
+      blk->cls_ = cls;
+      owned_.fetch_add(1, boost::memory_order_relaxed);
+    }
+    return blk;
+  }
+
+  /// Owner thread only.
+  void put(block* blk)
+  {
+    std::size_t cls = blk->cls_;
+    if (free_num_[cls] < GCE_BUFFER_POOL_CACHE_SIZE)
+    {
+      blk->next_ = free_list_[cls];
+      free_list_[cls] = blk;
+      ++free_num_[cls];
+    }
+    else
+    {
+      std::free(blk);
+      owned_.fetch_sub(1, boost::memory_order_relaxed);
+    }
+  }
+
+  /// Any other thread; false if the owner has exited.
+  static bool push(boost::atomic<block*>& lst, block* blk)
+  {
+    block* head = lst.load(boost::memory_order_acquire);
+    do
+    {
+      if (head == &closed_tag)
+      {
+        return false;
+      }
+      blk->next_ = head;
+    }
+    while (
+      !lst.compare_exchange_weak(
+        head, blk, boost::memory_order_release, boost::memory_order_acquire
+        )
+      );
+    return true;
+  }
+
+  /// Owner thread only; only it closes posted_.
+  void take_posted()
+  {
+    block* blk = posted_.load(boost::memory_order_relaxed);
+    if (blk && blk != &closed_tag)
+    {
+      run_posted(posted_.exchange(0, boost::memory_order_acquire));
+    }
+  }
+
+  static void run_posted(block* blk)
+  {
+    while (blk)
+    {
+      /// mrg may free blk.
+      block* next = blk->next_;
+      blk->merge_(get_data(blk));
+      blk = next;
+    }
+  }
+
+  void take_remote()
+  {
+    block* blk = remote_.exchange(0, boost::memory_order_acquire);
+    while (blk)
+    {
+      block* next = blk->next_;
+      put(blk);
+      blk = next;
+    }
+  }
+
+  /// Free a block no list keeps; last one out deletes the cache.
+  void release(block* blk)
+  {
+    std::free(blk);
+    release();
+  }
+
+  /// Keep the cache alive while another thread uses it.
+  void add_ref()
+  {
+    owned_.fetch_add(1, boost::memory_order_relaxed);
+  }
+
+  void release()
+  {
+    if (owned_.fetch_sub(1, boost::memory_order_acq_rel) == 1)
+    {
+      delete this;
+    }
+  }
+
+  /// Owner thread exits; blocks still in use come back through release.
+  static void close(thread_cache* cac)
+  {
+    /// Posted merges first, they may free blocks into this cache.
+    run_posted(cac->posted_.exchange(&closed_tag, boost::memory_order_acq_rel));
+    set_curr(0);
+
+    block* blk = cac->remote_.exchange(&closed_tag, boost::memory_order_acquire);
+    std::size_t n = 0;
+    for (std::size_t i=0; i<=class_num; ++i)
+    {
+      while (blk)
+      {
+        block* next = blk->next_;
+        std::free(blk);
+        ++n;
+        blk = next;
+      }
+
+      if (i < class_num)
+      {
+        blk = cac->free_list_[i];
+      }
+    }
+
+    if (cac->owned_.fetch_sub(n + 1, boost::memory_order_acq_rel) == n + 1)
+    {
+      delete cac;
+    }
+  }
+
+  block* free_list_[class_num];
+  std::size_t free_num_[class_num];
+
+  /// Blocks made by this cache and not freed yet, +1 while its thread lives.
+  boost::atomic_size_t owned_;
+  boost::atomic<block*> remote_;
+
+  /// Blocks whose merge_ the owner thread has to run.
+  boost::atomic<block*> posted_;
+
+  /// Owner thread only; set if its blocks' ref counts are biased to it.
+  bool biased_;
+
+  static void set_curr(thread_cache*);
+};
+
+boost::thread_specific_ptr<thread_cache>& get_tss()
+{
+  /// Never destroyed, buffers may be freed during static destruction.
+  static boost::thread_specific_ptr<thread_cache>* tss =
+    new boost::thread_specific_ptr<thread_cache>(&thread_cache::close);
+  return *tss;
+}
+
+/// The tss only cleans up at thread exit; its lookup is too slow for the
+/// ref count path, so keep a native thread local copy where there is one.
+#ifndef BOOST_NO_CXX11_THREAD_LOCAL
+thread_local thread_cache* curr_cache = 0;
+
+inline thread_cache* get_curr()
+{
+  return curr_cache;
+}
+
+void thread_cache::set_curr(thread_cache* cac)
+{
+  curr_cache = cac;
+}
+#else
+inline thread_cache* get_curr()
+{
+  return get_tss().get();
+}
+
+void thread_cache::set_curr(thread_cache*)
+{
+}
+#endif
+
+thread_cache* make_curr()
+{
+  thread_cache* cac = new thread_cache;
+  get_tss().reset(cac);
+  thread_cache::set_curr(cac);
+  return cac;
+}
+}
+///------------------------------------------------------------------------------
+byte_t* buffer_pool::allocate(std::size_t& size)
+{
+  std::size_t cls = get_class(size);
+  if (cls == cls_nil)
+  {
+    block* blk = make_block(size);
+    blk->owner_ = 0;
+    blk->cls_ = cls_nil;
+    return get_data(blk);
+  }
+
+  thread_cache* cac = get_curr();
+  if (!cac)
+  {
+    cac = make_curr();
+  }
+  else
+  {
+    cac->take_posted();
+  }
+
+  size = class_size(cls);
+  return get_data(cac->get(cls));
+}
+///------------------------------------------------------------------------------
+void buffer_pool::deallocate(byte_t* data)
+{
+  block* blk = get_block(data);
+  thread_cache* owner = blk->owner_;
+  if (!owner)
+  {
+    std::free(blk);
+  }
+  else if (owner == get_curr())
+  {
+    owner->put(blk);
+    owner->take_posted();
+  }
+  else if (!thread_cache::push(owner->remote_, blk))
+  {
+    owner->release(blk);
+  }
+}
+///------------------------------------------------------------------------------
+void const* buffer_pool::current_owner()
+{
+#ifndef BOOST_NO_CXX11_THREAD_LOCAL
+  thread_cache* cac = curr_cache;
+  return cac && cac->biased_ ? cac : 0;
+#else
+  /// A tss lookup per ref count change costs more than the atomic one.
+  return 0;
+#endif
+}
+///------------------------------------------------------------------------------
+void const* buffer_pool::get_owner(byte_t* data)
+{
+  return get_block(data)->owner_;
+}
+///------------------------------------------------------------------------------
+void buffer_pool::post(byte_t* data, merge_t mrg)
+{
+  block* blk = get_block(data);
+  BOOST_ASSERT(blk->owner_);
+  blk->merge_ = mrg;
+  thread_cache* owner = blk->owner_;
+
+  /// Once pushed, blk may be merged and freed, and the owner gone, under us.
+  owner->add_ref();
+  if (!thread_cache::push(owner->posted_, blk))
+  {
+    mrg(data);
+  }
+  owner->release();
+}
+///------------------------------------------------------------------------------
+void buffer_pool::bias()
+{
+  thread_cache* cac = get_curr();
+  if (!cac)
+  {
+    cac = make_curr();
+  }
+  cac->biased_ = true;
+}
+///------------------------------------------------------------------------------
+}
+}
@@ -13,98 +13,169 @@
 #include <gce/actor/detail/socket.hpp>
 #include <gce/actor/detail/acceptor.hpp>
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
 
 namespace gce
 {
 namespace detail
 {
 ///------------------------------------------------------------------------------
-cache_pool::cache_pool(context& ctx, std::size_t index, bool is_slice)
+cache_pool::cache_pool(
+  context& ctx, io_service_t& ios,
+  std::size_t index, bool is_slice
+  )
   : ctx_(&ctx)
   , index_(index)
-  , snd_(ctx.get_io_service())
+  , ios_(&ios)
+  , snd_(ios)
+  , per_actor_strand_(ctx.get_attributes().sched_mode_ == sched_actor)
+  , track_load_(ctx.get_attributes().placement_ == place_least_loaded)
+  , load_(0)
+  , activation_num_(0)
+  , preempt_num_(0)
+  , max_activation_(0)
+  , shed_num_(0)
+  , is_slice_(is_slice)
   , curr_router_list_(router_list_.end())
   , curr_socket_list_(conn_list_.end())
   , curr_joint_list_(joint_list_.end())
   , stopped_(false)
 {
-  context_switching_actor_pool_ = 
-    boost::in_place(
-      this, this,
-      size_nil,
-      is_slice ? 0 : ctx.get_attributes().actor_pool_reserve_size_
-      );
-  event_based_actor_pool_ = 
-    boost::in_place(
-      this, this,
-      size_nil,
-      is_slice ? 0 : ctx.get_attributes().actor_pool_reserve_size_
-      );
-  socket_pool_ = 
-    boost::in_place(
-      this, this,
-      size_nil,
-      is_slice ? 0 : ctx.get_attributes().socket_pool_reserve_size_
-      );
-  acceptor_pool_ = 
-    boost::in_place(
-      this, this,
-      size_nil,
-      is_slice ? 0 : ctx.get_attributes().acceptor_pool_reserve_size_
-      );
 }
 ///------------------------------------------------------------------------------
 cache_pool::~cache_pool()
 {
 }
 ///------------------------------------------------------------------------------
+void cache_pool::add_activation(duration_t dur, bool preempted)
+{
+  activation_num_.fetch_add(1, boost::memory_order_relaxed);
+  if (preempted)
+  {
+    preempt_num_.fetch_add(1, boost::memory_order_relaxed);
+  }
+
+  duration_t::rep curr = max_activation_.load(boost::memory_order_relaxed);
+  while (dur.count() > curr)
+  {
+    if (max_activation_.compare_exchange_weak(curr, dur.count()))
+    {
+      break;
+    }
+  }
+}
+///------------------------------------------------------------------------------
+fairness_stat cache_pool::get_fairness_stat() const
+{
+  fairness_stat stat;
+  stat.activation_num_ = activation_num_.load(boost::memory_order_relaxed);
+  stat.preempt_num_ = preempt_num_.load(boost::memory_order_relaxed);
+  stat.max_activation_ = duration_t(max_activation_.load(boost::memory_order_relaxed));
+  stat.shed_num_ = shed_num_.load(boost::memory_order_relaxed);
+  return stat;
+}
+///------------------------------------------------------------------------------
 coroutine_stackful_actor* cache_pool::get_context_switching_actor()
 {
+  scoped_lock lock(*this);
+  add_load();
+  if (!context_switching_actor_pool_)
+  {
+    context_switching_actor_pool_ = 
+      boost::in_place(
+        this, this,
+        size_nil,
+        is_slice_ ? 0 : ctx_->get_attributes().actor_pool_reserve_size_
+        );
+  }
   return context_switching_actor_pool_->get();
 }
 ///------------------------------------------------------------------------------
 coroutine_stackless_actor* cache_pool::get_event_based_actor()
 {
+  scoped_lock lock(*this);
+  add_load();
+  if (!event_based_actor_pool_)
+  {
+    event_based_actor_pool_ = 
+      boost::in_place(
+        this, this,
+        size_nil,
+        is_slice_ ? 0 : ctx_->get_attributes().actor_pool_reserve_size_
+        );
+  }
   return event_based_actor_pool_->get();
 }
 ///------------------------------------------------------------------------------
 socket* cache_pool::get_socket()
 {
+  scoped_lock lock(*this);
+  add_load();
+  if (!socket_pool_)
+  {
+    socket_pool_ = 
+      boost::in_place(
+        this, this,
+        size_nil,
+        is_slice_ ? 0 : ctx_->get_attributes().socket_pool_reserve_size_
+        );
+  }
   return socket_pool_->get();
 }
 ///------------------------------------------------------------------------------
 acceptor* cache_pool::get_acceptor()
 {
+  scoped_lock lock(*this);
+  add_load();
+  if (!acceptor_pool_)
+  {
+    acceptor_pool_ = 
+      boost::in_place(
+        this, this,
+        size_nil,
+        is_slice_ ? 0 : ctx_->get_attributes().acceptor_pool_reserve_size_
+        );
+  }
   return acceptor_pool_->get();
 }
 ///------------------------------------------------------------------------------
 void cache_pool::free_actor(coroutine_stackful_actor* a)
 {
+  scoped_lock lock(*this);
+  sub_load();
   context_switching_actor_pool_->free(a);
 }
 ///------------------------------------------------------------------------------
 void cache_pool::free_actor(coroutine_stackless_actor* a)
 {
+  scoped_lock lock(*this);
+  sub_load();
   event_based_actor_pool_->free(a);
 }
 ///------------------------------------------------------------------------------
 void cache_pool::free_socket(socket* skt)
 {
+  scoped_lock lock(*this);
+  sub_load();
   socket_pool_->free(skt);
 }
 ///------------------------------------------------------------------------------
 void cache_pool::free_acceptor(acceptor* acpr)
 {
+  scoped_lock lock(*this);
+  sub_load();
   acceptor_pool_->free(acpr);
 }
 ///------------------------------------------------------------------------------
 void cache_pool::register_service(match_t name, aid_t svc)
 {
+  scoped_lock lock(*this);
   service_list_.insert(std::make_pair(name, svc));
 }
 ///------------------------------------------------------------------------------
 aid_t cache_pool::find_service(match_t name)
 {
+  scoped_lock lock(*this);
   aid_t svc;
   service_list_t::iterator itr(service_list_.find(name));
   if (itr != service_list_.end())
@@ -116,6 +187,7 @@ aid_t cache_pool::find_service(match_t name)
 ///------------------------------------------------------------------------------
 void cache_pool::deregister_service(match_t name, aid_t svc)
 {
+  scoped_lock lock(*this);
   service_list_t::iterator itr(service_list_.find(name));
   if (itr != service_list_.end() && itr->second == svc)
   {
@@ -125,6 +197,7 @@ void cache_pool::deregister_service(match_t name, aid_t svc)
 ///------------------------------------------------------------------------------
 void cache_pool::register_socket(ctxid_pair_t ctxid_pr, aid_t skt)
 {
+  scoped_lock lock(*this);
   if (ctxid_pr.second == socket_router)
   {
     std::pair<conn_list_t::iterator, bool> pr =
@@ -177,6 +250,7 @@ void cache_pool::register_socket(ctxid_pair_t ctxid_pr, aid_t skt)
 ///------------------------------------------------------------------------------
 aid_t cache_pool::select_socket(ctxid_t ctxid, ctxid_t* target)
 {
+  scoped_lock lock(*this);
   aid_t skt = select_straight_socket(ctxid, target);
   if (!skt)
   {
@@ -242,6 +316,7 @@ aid_t cache_pool::select_straight_socket(ctxid_t ctxid, ctxid_t* target)
 ///------------------------------------------------------------------------------
 aid_t cache_pool::select_joint_socket(ctxid_t ctxid, ctxid_t* target)
 {
+  scoped_lock lock(*this);
   aid_t skt;
   skt_list_t* skt_list = 0;
   skt_list_t::iterator* curr_skt = 0;
@@ -334,6 +409,7 @@ aid_t cache_pool::select_router(ctxid_t* target)
 ///------------------------------------------------------------------------------
 void cache_pool::deregister_socket(ctxid_pair_t ctxid_pr, aid_t skt)
 {
+  scoped_lock lock(*this);
   if (ctxid_pr.second == socket_router)
   {
     conn_list_t::iterator itr(router_list_.find(ctxid_pr.first));
@@ -366,40 +442,61 @@ void cache_pool::deregister_socket(ctxid_pair_t ctxid_pr, aid_t skt)
   }
 }
 ///------------------------------------------------------------------------------
-void cache_pool::add_socket(socket* s)
+bool cache_pool::add_socket(socket* s)
 {
+  scoped_lock lock(*this);
+  if (stopped_)
+  {
+    return false;
+  }
   socket_list_.insert(s);
+  return true;
 }
 ///------------------------------------------------------------------------------
-void cache_pool::add_acceptor(acceptor* a)
+bool cache_pool::add_acceptor(acceptor* a)
 {
+  scoped_lock lock(*this);
+  if (stopped_)
+  {
+    return false;
+  }
   acceptor_list_.insert(a);
+  return true;
 }
 ///------------------------------------------------------------------------------
 void cache_pool::remove_socket(socket* s)
 {
+  scoped_lock lock(*this);
   socket_list_.erase(s);
 }
 ///------------------------------------------------------------------------------
 void cache_pool::remove_acceptor(acceptor* a)
 {
+  scoped_lock lock(*this);
   acceptor_list_.erase(a);
 }
 ///------------------------------------------------------------------------------
 void cache_pool::stop()
 {
-  stopped_ = true;
-  BOOST_FOREACH(socket* s, socket_list_)
+  std::set<socket*> socket_list;
+  std::set<acceptor*> acceptor_list;
+  {
+    scoped_lock lock(*this);
+    stopped_ = true;
+    socket_list.swap(socket_list_);
+    acceptor_list.swap(acceptor_list_);
+  }
+
+  /// Sockets and acceptors may run on their own strands (sched_actor).
+  BOOST_FOREACH(socket* s, socket_list)
   {
-    s->stop();
+    s->get_strand().dispatch(boost::bind(&socket::stop, s));
   }
-  socket_list_.clear();
 
-  BOOST_FOREACH(acceptor* a, acceptor_list_)
+  BOOST_FOREACH(acceptor* a, acceptor_list)
   {
-    a->stop();
+    a->get_strand().dispatch(boost::bind(&acceptor::stop, a));
   }
-  acceptor_list_.clear();
 }
 ///------------------------------------------------------------------------------
 }
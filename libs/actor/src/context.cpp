@@ -11,6 +11,9 @@
 #include <gce/actor/nonblocking_actor.hpp>
 #include <gce/actor/thread_mapped_actor.hpp>
 #include <gce/actor/detail/cache_pool.hpp>
+#include <gce/actor/detail/affinity.hpp>
+#include <gce/actor/detail/buffer_pool.hpp>
+#include <gce/detail/cpu_relax.hpp>
 #include <boost/asio/placeholders.hpp>
 #include <boost/foreach.hpp>
 #include <boost/ref.hpp>
@@ -23,41 +26,110 @@ namespace gce
 /// context
 ///------------------------------------------------------------------------------
 context::context(attributes attrs)
-  : attrs_(attrs)
+  : attrs_(make_attributes(attrs))
   , timestamp_((timestamp_t)boost::chrono::system_clock::now().time_since_epoch().count())
-  , curr_cache_pool_(size_nil)
-  , cache_pool_size_(
+  , match_index_(attrs_.match_index_size_)
+  , curr_cache_pool_(0)
+  , default_pool_size_(
       attrs_.thread_num_ == 0 ? 
         attrs_.per_thread_cache_pool_num_ : 
         attrs_.thread_num_ * attrs_.per_thread_cache_pool_num_
       )
+  , cache_pool_size_(default_pool_size_)
   , cache_queue_size_(cache_pool_size_ + attrs_.slice_num_)
+  , stopping_pool_num_(0)
+  , blocking_stopped_(false)
+  , elastic_slot_num_(0)
+  , elastic_thread_num_(0)
+  , retire_num_(0)
+  , probe_pending_(false)
+  , probe_slow_(false)
+  , next_thread_id_(attrs_.thread_num_)
+  , quiet_period_num_(0)
+  , elastic_stopped_(false)
+  , ready_thread_num_(0)
   , curr_nonblocking_actor_(0)
   , thread_mapped_actor_list_(cache_pool_size_)
 {
+  if (attrs_.stall_threshold_ > zero)
+  {
+    watchdog_.reset(new detail::watchdog(attrs_.stall_threshold_, attrs_.stall_cb_));
+  }
+
+  bool sharded = !attrs_.ios_ && attrs_.per_thread_io_service_ && attrs_.thread_num_ > 1;
   if (attrs_.ios_)
   {
     ios_.reset(attrs_.ios_, detail::empty_deleter<io_service_t>());
   }
   else
   {
-    ios_.reset(new io_service_t(attrs_.thread_num_));
+    /// Elastic threads run ios_ too; a hint of 1 would keep asio from
+    /// waking a parked thread for queued handlers.
+    std::size_t hint =
+      attrs_.max_thread_num_ > attrs_.thread_num_ ?
+        attrs_.max_thread_num_ : attrs_.thread_num_;
+    ios_.reset(new io_service_t(sharded ? 1 : hint));
+  }
+  ios_list_.push_back(ios_.get());
+  BOOST_FOREACH(pool_attributes const& pattrs, attrs_.pool_list_)
+  {
+    cache_pool_size_ += pattrs.thread_num_ * attrs_.per_thread_cache_pool_num_;
   }
-  work_ = boost::in_place(boost::ref(*ios_));
+  cache_queue_size_ = cache_pool_size_ + attrs_.slice_num_;
   cache_pool_list_.resize(cache_pool_size_, 0);
   nonblocking_actor_list_.resize(attrs_.slice_num_, 0);
 
   try
   {
-    std::size_t index = 0;
-    for (std::size_t i=0; i<cache_pool_size_; ++i, ++index)
+    if (sharded)
     {
-      cache_pool_list_[i] = new detail::cache_pool(*this, index);
+      ios_list_.reserve(attrs_.thread_num_);
+      for (std::size_t i=1; i<attrs_.thread_num_; ++i)
+      {
+        ios_list_.push_back(new io_service_t(1));
+      }
     }
 
-    for (std::size_t i=0; i<attrs_.slice_num_; ++i, ++index)
+    BOOST_FOREACH(io_service_t* ios, ios_list_)
     {
-      nonblocking_actor_list_[i] = new nonblocking_actor(*this, index);
+      work_list_.push_back(io_service_t::work(*ios));
+    }
+
+    bool use_numa =
+      attrs_.numa_policy_ == numa_local &&
+      !attrs_.cpu_list_.empty() &&
+      attrs_.thread_num_ > 0;
+    if (use_numa)
+    {
+      /// Pool i is built and mostly run by thread i % thread_num_.
+      pool_node_list_.resize(default_pool_size_, 0);
+      std::size_t node_num = 0;
+      for (std::size_t i=0; i<default_pool_size_; ++i)
+      {
+        thrid_t id = i % attrs_.thread_num_;
+        std::size_t node =
+          detail::get_cpu_node(attrs_.cpu_list_[id % attrs_.cpu_list_.size()]);
+        pool_node_list_[i] = node;
+        node_num = (std::max)(node_num, node + 1);
+      }
+
+      node_pool_list_.resize(node_num);
+      curr_node_pool_.reset(new boost::atomic_size_t[node_num]);
+      for (std::size_t i=0; i<node_num; ++i)
+      {
+        curr_node_pool_[i] = 0;
+      }
+      for (std::size_t i=0; i<default_pool_size_; ++i)
+      {
+        node_pool_list_[pool_node_list_[i]].push_back(i);
+      }
+    }
+    else
+    {
+      for (std::size_t i=0; i<default_pool_size_; ++i)
+      {
+        make_cache_pool(i);
+      }
     }
 
     for (std::size_t i=0; i<attrs_.thread_num_; ++i)
@@ -65,11 +137,53 @@ context::context(attributes attrs)
       thread_group_.create_thread(
         boost::bind(
           &context::run, this, i,
+          ios_list_[i % ios_list_.size()],
           attrs_.thread_begin_cb_list_,
           attrs_.thread_end_cb_list_
           )
         );
     }
+
+    if (use_numa)
+    {
+      while (ready_thread_num_ < attrs_.thread_num_)
+      {
+        boost::this_thread::yield();
+      }
+
+      for (std::size_t i=0; i<default_pool_size_; ++i)
+      {
+        if (!cache_pool_list_[i])
+        {
+          throw std::runtime_error("make numa local cache_pool failed");
+        }
+      }
+    }
+
+    make_named_pools();
+
+    for (std::size_t i=0; i<attrs_.slice_num_; ++i)
+    {
+      nonblocking_actor_list_[i] = new nonblocking_actor(*this, cache_pool_size_ + i);
+    }
+
+    if (
+      attrs_.thread_num_ > 0 &&
+      attrs_.max_thread_num_ > attrs_.thread_num_ &&
+      ios_list_.size() == 1
+      )
+    {
+      elastic_slot_num_ = attrs_.max_thread_num_ - attrs_.thread_num_;
+      elastic_slot_list_.reset(new elastic_slot[elastic_slot_num_]);
+      for (std::size_t i=0; i<elastic_slot_num_; ++i)
+      {
+        elastic_slot_list_[i].id_ = next_thread_id_++;
+      }
+
+      elastic_snd_ = boost::in_place(boost::ref(*ios_));
+      elastic_tmr_.reset(new timer_t(*ios_));
+      elastic_snd_->dispatch(boost::bind(&context::start_elastic_timer, this));
+    }
   }
   catch (...)
   {
@@ -92,14 +206,91 @@ thread_mapped_actor& context::make_thread_mapped_actor()
 ///------------------------------------------------------------------------------
 detail::cache_pool* context::select_cache_pool()
 {
-  std::size_t curr_cache_pool = curr_cache_pool_;
-  ++curr_cache_pool;
-  if (curr_cache_pool >= cache_pool_size_)
+  /// Called from any thread.
+  std::size_t i = curr_cache_pool_.fetch_add(1, boost::memory_order_relaxed);
+  return cache_pool_list_[i % default_pool_size_];
+}
+///------------------------------------------------------------------------------
+detail::cache_pool* context::select_cache_pool(detail::cache_pool* near)
+{
+  if (near && near->get_index() >= default_pool_size_)
+  {
+    /// named pool or nonblocking_actor's slice
+    near = 0;
+  }
+
+  if (node_pool_list_.empty() || !near)
+  {
+    if (attrs_.placement_ == place_least_loaded)
+    {
+      detail::cache_pool* a = select_cache_pool();
+      return select_least_loaded(near, select_least_loaded(a, select_cache_pool()));
+    }
+    return select_cache_pool();
+  }
+
+  std::size_t node = pool_node_list_[near->get_index()];
+  std::vector<std::size_t> const& pool_list = node_pool_list_[node];
+  boost::atomic_size_t& curr = curr_node_pool_[node];
+  detail::cache_pool* a =
+    cache_pool_list_[
+      pool_list[curr.fetch_add(1, boost::memory_order_relaxed) % pool_list.size()]
+      ];
+  if (attrs_.placement_ == place_least_loaded)
+  {
+    detail::cache_pool* b =
+      cache_pool_list_[
+        pool_list[curr.fetch_add(1, boost::memory_order_relaxed) % pool_list.size()]
+        ];
+    a = select_least_loaded(near, select_least_loaded(a, b));
+  }
+  return a;
+}
+///------------------------------------------------------------------------------
+detail::cache_pool* context::select_cache_pool(pool_name pool)
+{
+  if (pool.name_ == match_nil)
+  {
+    return select_cache_pool();
+  }
+
+  for (std::size_t k=0; k<named_pool_list_.size(); ++k)
   {
-    curr_cache_pool = 0;
+    named_pool const& np = named_pool_list_[k];
+    if (np.name_ == pool.name_)
+    {
+      std::size_t i = curr_named_pool_[k].fetch_add(1, boost::memory_order_relaxed);
+      return cache_pool_list_[np.begin_ + i % np.size_];
+    }
   }
-  curr_cache_pool_ = curr_cache_pool;
-  return cache_pool_list_[curr_cache_pool];
+  throw std::runtime_error("named pool not found");
+}
+///------------------------------------------------------------------------------
+detail::cache_pool* context::select_net_cache_pool(
+  match_t pool, detail::cache_pool* near
+  )
+{
+  if (pool == match_nil)
+  {
+    pool = attrs_.io_pool_;
+  }
+
+  if (pool == match_nil)
+  {
+    return select_cache_pool(near);
+  }
+  return select_cache_pool(pool_name(pool));
+}
+///------------------------------------------------------------------------------
+detail::cache_pool* context::select_least_loaded(
+  detail::cache_pool* a, detail::cache_pool* b
+  )
+{
+  if (!a)
+  {
+    return b;
+  }
+  return b->get_load() < a->get_load() ? b : a;
 }
 ///------------------------------------------------------------------------------
 nonblocking_actor& context::make_nonblocking_actor()
@@ -112,6 +303,49 @@ nonblocking_actor& context::make_nonblocking_actor()
   return *(nonblocking_actor_list_[i]);
 }
 ///------------------------------------------------------------------------------
+std::vector<fairness_stat> context::get_fairness_stat()
+{
+  std::vector<fairness_stat> ret;
+  ret.reserve(cache_pool_size_);
+  BOOST_FOREACH(detail::cache_pool* cac_pool, cache_pool_list_)
+  {
+    ret.push_back(cac_pool->get_fairness_stat());
+  }
+  return ret;
+}
+///------------------------------------------------------------------------------
+void context::post_blocking(boost::function<void ()> const& f)
+{
+  boost::mutex::scoped_lock lock(blocking_mtx_);
+  if (blocking_stopped_)
+  {
+    throw std::runtime_error("context stopped, can't offload");
+  }
+
+  if (!blocking_ios_)
+  {
+    std::size_t thread_num = (std::max)(attrs_.blocking_thread_num_, std::size_t(1));
+    blocking_ios_.reset(new io_service_t(thread_num));
+    blocking_work_ = boost::in_place(boost::ref(*blocking_ios_));
+    for (std::size_t i=0; i<thread_num; ++i)
+    {
+      blocking_thread_group_.create_thread(
+        boost::bind(&context::run_blocking, this)
+        );
+    }
+  }
+  blocking_ios_->post(f);
+}
+///------------------------------------------------------------------------------
+void context::check_blocking()
+{
+  boost::mutex::scoped_lock lock(blocking_mtx_);
+  if (blocking_stopped_)
+  {
+    throw std::runtime_error("context stopped, can't offload");
+  }
+}
+///------------------------------------------------------------------------------
 void context::register_service(match_t name, aid_t svc, std::size_t cache_queue_index)
 {
   BOOST_FOREACH(detail::cache_pool* cac_pool, cache_pool_list_)
@@ -185,11 +419,25 @@ void context::deregister_socket(ctxid_pair_t ctxid_pr, aid_t skt, std::size_t ca
 }
 ///------------------------------------------------------------------------------
 void context::run(
-  thrid_t id,
+  thrid_t id, io_service_t* ios,
   std::vector<thread_callback_t> const& begin_cb_list,
   std::vector<thread_callback_t> const& end_cb_list
   )
 {
+  if (!attrs_.cpu_list_.empty())
+  {
+    detail::set_thread_affinity(attrs_.cpu_list_[id % attrs_.cpu_list_.size()]);
+  }
+
+  /// Runs actors for the context's lifetime, so buffer ref counts made here
+  /// can stay biased to it.
+  detail::buffer_pool::bias();
+
+  if (!node_pool_list_.empty() && id < attrs_.thread_num_)
+  {
+    make_local_cache_pools(id);
+  }
+
   BOOST_FOREACH(thread_callback_t const& cb, begin_cb_list)
   {
     cb(id);
@@ -199,7 +447,7 @@ void context::run(
   {
     try
     {
-      ios_->run();
+      run_io_service(*ios);
       break;
     }
     catch (...)
@@ -217,15 +465,58 @@ void context::run(
 ///------------------------------------------------------------------------------
 void context::stop()
 {
-  work_ = boost::none;
+  /// offload()s from now on fail, and so do queued ones not yet started
+  /// (check_blocking), resuming their actors with the error on ios_list_,
+  /// which still runs; so this joins only the calls in flight, a call that
+  /// never returns hangs here.
+  {
+    boost::mutex::scoped_lock lock(blocking_mtx_);
+    blocking_stopped_ = true;
+    blocking_work_.reset();
+  }
+  blocking_thread_group_.join_all();
+
+  if (elastic_snd_)
+  {
+    elastic_snd_->post(boost::bind(&context::stop_elastic, this));
+  }
+
+  std::size_t pool_num = 0;
+  std::size_t thread_num = attrs_.thread_num_;
   BOOST_FOREACH(detail::cache_pool* cac_pool, cache_pool_list_)
   {
-    cac_pool->get_strand().dispatch(
-      boost::bind(&detail::cache_pool::stop, cac_pool)
-      );
+    pool_num += cac_pool ? 1 : 0;
+  }
+  BOOST_FOREACH(pool_attributes const& pattrs, attrs_.pool_list_)
+  {
+    thread_num += pattrs.thread_num_;
+  }
+
+  if (pool_num == 0 || thread_group_.size() < thread_num)
+  {
+    /// Failed in ctor, no actor ever ran; some pools may have no thread.
+    work_list_.clear();
+  }
+
+  stopping_pool_num_ = pool_num;
+  BOOST_FOREACH(detail::cache_pool* cac_pool, cache_pool_list_)
+  {
+    if (cac_pool)
+    {
+      cac_pool->get_strand().dispatch(
+        boost::bind(&context::stop_cache_pool, this, cac_pool)
+        );
+    }
   }
 
   thread_group_.join_all();
+  for (std::size_t i=0; i<elastic_slot_num_; ++i)
+  {
+    if (elastic_slot_list_[i].thr_.joinable())
+    {
+      elastic_slot_list_[i].thr_.join();
+    }
+  }
 
   thread_mapped_actor* mix = 0;
   while (thread_mapped_actor_list_.pop(mix))
@@ -242,6 +533,351 @@ void context::stop()
   {
     delete cac_pool;
   }
+
+  for (std::size_t i=1; i<ios_list_.size(); ++i)
+  {
+    delete ios_list_[i];
+  }
+
+  BOOST_FOREACH(io_service_t* ios, named_ios_list_)
+  {
+    delete ios;
+  }
+
+  watchdog_.reset();
+}
+///------------------------------------------------------------------------------
+void context::stop_cache_pool(detail::cache_pool* cac_pool)
+{
+  cac_pool->stop();
+
+  /// With many io_services, one running out of work would exit before
+  /// others post it the last handlers (e.g. exit msgs); so every thread
+  /// keeps its io_service till all pools stopped.
+  if (--stopping_pool_num_ == 0)
+  {
+    work_list_.clear();
+  }
+}
+///------------------------------------------------------------------------------
+void context::run_elastic(
+  elastic_slot& slot,
+  std::vector<thread_callback_t> const& begin_cb_list,
+  std::vector<thread_callback_t> const& end_cb_list
+  )
+{
+  thrid_t id = slot.id_;
+  if (!attrs_.cpu_list_.empty())
+  {
+    detail::set_thread_affinity(attrs_.cpu_list_[id % attrs_.cpu_list_.size()]);
+  }
+
+  BOOST_FOREACH(thread_callback_t const& cb, begin_cb_list)
+  {
+    cb(id);
+  }
+
+  while (true)
+  {
+    try
+    {
+      run_io_service(*ios_, true);
+      break;
+    }
+    catch (...)
+    {
+      std::cerr << "Unexpected exception: " <<
+        boost::current_exception_diagnostic_information();
+    }
+  }
+
+  --elastic_thread_num_;
+  BOOST_FOREACH(thread_callback_t const& cb, end_cb_list)
+  {
+    cb(id);
+  }
+  slot.free_ = true;
+}
+///------------------------------------------------------------------------------
+void context::start_elastic_timer()
+{
+  if (elastic_stopped_)
+  {
+    return;
+  }
+
+  if (!probe_pending_)
+  {
+    /// Probe run queue: how long a new handler waits before it runs.
+    probe_pending_ = true;
+    ios_->post(
+      boost::bind(
+        &context::handle_probe, this,
+        boost::chrono::steady_clock::now()
+        )
+      );
+  }
+
+  elastic_tmr_->expires_from_now(attrs_.elastic_period_);
+  elastic_tmr_->async_wait(
+    elastic_snd_->wrap(
+      boost::bind(
+        &context::handle_elastic_timeout, this,
+        boost::asio::placeholders::error
+        )
+      )
+    );
+}
+///------------------------------------------------------------------------------
+void context::handle_elastic_timeout(errcode_t const& ec)
+{
+  if (ec || elastic_stopped_)
+  {
+    return;
+  }
+
+  if (probe_pending_ || probe_slow_)
+  {
+    quiet_period_num_ = 0;
+    for (std::size_t i=0; i<elastic_slot_num_; ++i)
+    {
+      elastic_slot& slot = elastic_slot_list_[i];
+      if (!slot.free_)
+      {
+        continue;
+      }
+
+      /// A retired thread has finished its end callbacks, join returns soon.
+      if (slot.thr_.joinable())
+      {
+        slot.thr_.join();
+      }
+
+      slot.free_ = false;
+      ++elastic_thread_num_;
+      slot.thr_ =
+        boost::thread(
+          boost::bind(
+            &context::run_elastic, this, boost::ref(slot),
+            attrs_.thread_begin_cb_list_,
+            attrs_.thread_end_cb_list_
+            )
+          );
+      break;
+    }
+  }
+  else if (++quiet_period_num_ >= 10)
+  {
+    quiet_period_num_ = 0;
+    if (elastic_thread_num_ > retire_num_)
+    {
+      ++retire_num_;
+    }
+  }
+
+  if (retire_num_ > 0)
+  {
+    /// Wake up a parked thread to retire.
+    ios_->post(boost::bind(&context::wake_up, this));
+  }
+
+  start_elastic_timer();
+}
+///------------------------------------------------------------------------------
+void context::handle_probe(boost::chrono::steady_clock::time_point tp)
+{
+  duration_t delay =
+    boost::chrono::duration_cast<duration_t>(
+      boost::chrono::steady_clock::now() - tp
+      );
+  probe_slow_ = delay * 10 > attrs_.elastic_period_;
+  probe_pending_ = false;
+}
+///------------------------------------------------------------------------------
+void context::run_blocking()
+{
+  while (true)
+  {
+    try
+    {
+      blocking_ios_->run();
+      break;
+    }
+    catch (...)
+    {
+      std::cerr << "Unexpected exception: " <<
+        boost::current_exception_diagnostic_information();
+    }
+  }
+}
+///------------------------------------------------------------------------------
+void context::wake_up()
+{
+}
+///------------------------------------------------------------------------------
+void context::stop_elastic()
+{
+  elastic_stopped_ = true;
+  errcode_t ec;
+  elastic_tmr_->cancel(ec);
+}
+///------------------------------------------------------------------------------
+bool context::try_retire()
+{
+  std::size_t retire_num = retire_num_;
+  while (retire_num > 0)
+  {
+    if (retire_num_.compare_exchange_weak(retire_num, retire_num - 1))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+///------------------------------------------------------------------------------
+void context::run_io_service(io_service_t& ios, bool elastic)
+{
+  if (attrs_.spin_period_ <= zero)
+  {
+    if (!elastic)
+    {
+      ios.run();
+      return;
+    }
+
+    /// Blocks (parks) in io_service while there is nothing to run.
+    while (ios.run_one() > 0)
+    {
+      if (try_retire())
+      {
+        break;
+      }
+    }
+    return;
+  }
+
+  typedef boost::chrono::steady_clock clock_t;
+  bool idle = false;
+  clock_t::time_point idle_begin;
+  while (!ios.stopped())
+  {
+    if (ios.poll_one() > 0)
+    {
+      idle = false;
+      if (elastic && try_retire())
+      {
+        break;
+      }
+      continue;
+    }
+
+    if (!idle)
+    {
+      idle = true;
+      idle_begin = clock_t::now();
+    }
+    else if (clock_t::now() - idle_begin >= attrs_.spin_period_)
+    {
+      /// Park until next handler.
+      idle = false;
+      if (ios.run_one() == 0 || (elastic && try_retire()))
+      {
+        break;
+      }
+      continue;
+    }
+    detail::cpu_relax();
+  }
+}
+///------------------------------------------------------------------------------
+attributes context::make_attributes(attributes attrs)
+{
+  BOOST_FOREACH(pool_attributes& pattrs, attrs.pool_list_)
+  {
+    if (pattrs.thread_num_ == 0)
+    {
+      pattrs.thread_num_ = 1;
+    }
+  }
+
+  if (attrs.io_pool_ != match_nil)
+  {
+    bool found = false;
+    BOOST_FOREACH(pool_attributes const& pattrs, attrs.pool_list_)
+    {
+      found = found || pattrs.name_ == attrs.io_pool_;
+    }
+
+    if (!found)
+    {
+      attrs.pool_list_.push_back(pool_attributes(attrs.io_pool_));
+    }
+  }
+  return attrs;
+}
+///------------------------------------------------------------------------------
+void context::make_named_pools()
+{
+  /// Named pools' cache_pools follow the default ones, their threads and
+  /// io_services are their own.
+  std::size_t pool_num = attrs_.pool_list_.size();
+  curr_named_pool_.reset(new boost::atomic_size_t[pool_num]);
+  named_ios_list_.reserve(pool_num);
+
+  std::size_t index = default_pool_size_;
+  for (std::size_t k=0; k<pool_num; ++k)
+  {
+    pool_attributes const& pattrs = attrs_.pool_list_[k];
+    io_service_t* ios = new io_service_t(pattrs.thread_num_);
+    named_ios_list_.push_back(ios);
+    work_list_.push_back(io_service_t::work(*ios));
+
+    named_pool np;
+    np.name_ = pattrs.name_;
+    np.begin_ = index;
+    np.size_ = pattrs.thread_num_ * attrs_.per_thread_cache_pool_num_;
+    named_pool_list_.push_back(np);
+    curr_named_pool_[k] = 0;
+
+    for (std::size_t i=0; i<np.size_; ++i, ++index)
+    {
+      cache_pool_list_[index] = new detail::cache_pool(*this, *ios, index);
+    }
+
+    for (std::size_t i=0; i<pattrs.thread_num_; ++i)
+    {
+      thread_group_.create_thread(
+        boost::bind(
+          &context::run, this, next_thread_id_++, ios,
+          attrs_.thread_begin_cb_list_,
+          attrs_.thread_end_cb_list_
+          )
+        );
+    }
+  }
+}
+///------------------------------------------------------------------------------
+void context::make_cache_pool(std::size_t index)
+{
+  io_service_t& ios = *ios_list_[index % ios_list_.size()];
+  cache_pool_list_[index] = new detail::cache_pool(*this, ios, index);
+}
+///------------------------------------------------------------------------------
+void context::make_local_cache_pools(thrid_t id)
+{
+  /// Built on the pinned thread, so the pool's memory is first-touched on
+  /// its own node; a failure leaves a null pool for ctor to report.
+  try
+  {
+    for (std::size_t i=id; i<default_pool_size_; i+=attrs_.thread_num_)
+    {
+      make_cache_pool(i);
+    }
+  }
+  catch (...)
+  {
+  }
+  ++ready_thread_num_;
 }
 ///------------------------------------------------------------------------------
 }
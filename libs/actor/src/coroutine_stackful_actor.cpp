@@ -20,19 +20,25 @@
 #include <boost/asio/placeholders.hpp>
 #include <boost/bind.hpp>
 #include <boost/variant/get.hpp>
+#include <boost/move/utility.hpp>
+#include <stdexcept>
 
 namespace gce
 {
 ///----------------------------------------------------------------------------
 coroutine_stackful_actor::coroutine_stackful_actor(detail::cache_pool* user)
-  : base_type(&user->get_context(), user, user->get_index())
+  : base_type(
+      &user->get_context(), user,
+      user->get_index(), user->per_actor_strand()
+      )
   , stat_(ready)
   , recving_(false)
   , responsing_(false)
-  , tmr_(ctx_->get_io_service())
+  , tmr_(user_->get_io_service())
   , tmr_sid_(0)
   , yld_(0)
 {
+  base_type::count_on_pop();
 }
 ///----------------------------------------------------------------------------
 coroutine_stackful_actor::~coroutine_stackful_actor()
@@ -43,8 +49,10 @@ aid_t coroutine_stackful_actor::recv(message& msg, match const& mach)
 {
   aid_t sender;
   detail::recv_t rcv;
+  match tmp;
+  match const& filter = base_type::filter_match(mach, tmp);
 
-  if (!mb_.pop(rcv, msg, mach.match_list_))
+  if (!base_type::pop_msg(rcv, msg, filter))
   {
     duration_t tmo = mach.timeout_;
     if (tmo > zero)
@@ -54,7 +62,7 @@ aid_t coroutine_stackful_actor::recv(message& msg, match const& mach)
       {
         start_recv_timer(tmo);
       }
-      curr_match_ = mach;
+      curr_match_ = filter;
       actor_code ac = yield();
       if (ac == actor_timeout)
       {
@@ -62,7 +70,7 @@ aid_t coroutine_stackful_actor::recv(message& msg, match const& mach)
       }
 
       rcv = recving_rcv_;
-      msg = recving_msg_;
+      msg = boost::move(recving_msg_);
       recving_rcv_ = detail::recv_t();
       recving_msg_ = message();
     }
@@ -71,6 +79,7 @@ aid_t coroutine_stackful_actor::recv(message& msg, match const& mach)
       return sender;
     }
   }
+  yield_budget();
 
   if (aid_t* aid = boost::get<aid_t>(&rcv))
   {
@@ -110,7 +119,7 @@ aid_t coroutine_stackful_actor::recv(response_t res, message& msg, duration_t tm
       }
 
       res = recving_res_;
-      msg = recving_msg_;
+      msg = boost::move(recving_msg_);
       recving_res_ = response_t();
       recving_msg_ = message();
     }
@@ -119,17 +128,81 @@ aid_t coroutine_stackful_actor::recv(response_t res, message& msg, duration_t tm
       return sender;
     }
   }
+  yield_budget();
 
   sender = res.get_aid();
   return sender;
 }
 ///----------------------------------------------------------------------------
+std::size_t coroutine_stackful_actor::recv_batch(
+  msg_batch_t& batch, std::size_t max_n, match const& mach
+  )
+{
+  if (max_n == 0)
+  {
+    return 0;
+  }
+
+  message msg;
+  aid_t sender = recv(msg, mach);
+  if (!sender)
+  {
+    return 0;
+  }
+
+  batch.push_back(msg_batch_t::value_type(sender, message()));
+  batch.back().second = boost::move(msg);
+  return 1 + base_type::pop_batch(batch, max_n - 1, mach);
+}
+///----------------------------------------------------------------------------
+std::size_t coroutine_stackful_actor::recv_responses(
+  response_list_t& pending, res_batch_t& batch, duration_t tmo, bool all
+  )
+{
+  std::size_t old_size = batch.size();
+  std::size_t n = base_type::pop_responses(pending, batch);
+  if (pending.empty() || (n > 0 && !all) || tmo <= zero)
+  {
+    if (n > 0)
+    {
+      yield_budget();
+    }
+    return n;
+  }
+
+  res_gather_.start(pending, batch, all);
+  if (tmo < infin)
+  {
+    start_recv_timer(tmo);
+  }
+  yield();
+  res_gather_.finish();
+  return batch.size() - old_size;
+}
+///----------------------------------------------------------------------------
 void coroutine_stackful_actor::wait(duration_t dur)
 {
   start_recv_timer(dur);
   yield();
 }
 ///----------------------------------------------------------------------------
+void coroutine_stackful_actor::offload(offload_func_t const& f)
+{
+  boost::optional<std::string> errmsg;
+  ctx_->post_blocking(
+    boost::bind(
+      &coroutine_stackful_actor::run_offload, this,
+      f, boost::ref(errmsg)
+      )
+    );
+  yield();
+
+  if (errmsg)
+  {
+    throw std::runtime_error(*errmsg);
+  }
+}
+///----------------------------------------------------------------------------
 yield_t coroutine_stackful_actor::get_yield()
 {
   BOOST_ASSERT(yld_);
@@ -170,6 +243,7 @@ void coroutine_stackful_actor::on_free()
   stat_ = ready;
   f_.clear();
   curr_match_.clear();
+  res_gather_.clear();
 
   recving_ = false;
   responsing_ = false;
@@ -182,27 +256,13 @@ void coroutine_stackful_actor::on_free()
 ///----------------------------------------------------------------------------
 void coroutine_stackful_actor::on_recv(detail::pack& pk, base_type::send_hint hint)
 {
-  if (hint == base_type::sync)
-  {
-    snd_.dispatch(
-      boost::bind(
-        &coroutine_stackful_actor::handle_recv, this, pk
-        )
-      );
-  }
-  else
-  {
-    snd_.post(
-      boost::bind(
-        &coroutine_stackful_actor::handle_recv, this, pk
-        )
-      );
-  }
+  base_type::push_inbox(pk, hint);
 }
 ///----------------------------------------------------------------------------
 void coroutine_stackful_actor::run(yield_t yld)
 {
   yld_ = &yld;
+  base_type::begin_activation();
 
   try
   {
@@ -226,11 +286,24 @@ void coroutine_stackful_actor::run(yield_t yld)
   }
 }
 ///----------------------------------------------------------------------------
-void coroutine_stackful_actor::resume(actor_code ac)
+void coroutine_stackful_actor::resume(actor_code ac, bool drained)
 {
   detail::scope scp(boost::bind(&coroutine_stackful_actor::free_self, this));
   BOOST_ASSERT(yld_cb_);
-  yld_cb_(ac);
+  if (!drained)
+  {
+    base_type::begin_activation();
+  }
+
+  {
+    detail::watchdog::scope wdg_scp(wdg_, get_aid(), match_nil);
+    yld_cb_(ac);
+  }
+
+  if (!drained)
+  {
+    base_type::end_activation();
+  }
 
   if (stat_ != off)
   {
@@ -249,6 +322,39 @@ coroutine_stackful_actor::actor_code coroutine_stackful_actor::yield()
   return init.result.get();
 }
 ///----------------------------------------------------------------------------
+void coroutine_stackful_actor::yield_budget()
+{
+  /// A tight recv loop on a full mailbox never yields by itself.
+  if (base_type::consume_budget())
+  {
+    base_type::end_activation();
+    snd_.post(boost::bind(&coroutine_stackful_actor::resume, this, actor_normal, false));
+    yield();
+  }
+}
+///----------------------------------------------------------------------------
+void coroutine_stackful_actor::run_offload(
+  offload_func_t const& f, boost::optional<std::string>& errmsg
+  )
+{
+  /// In a blocking thread; errmsg lives on the suspended coroutine's stack.
+  try
+  {
+    ctx_->check_blocking();
+    f();
+  }
+  catch (std::exception& ex)
+  {
+    errmsg = ex.what();
+  }
+  catch (...)
+  {
+    errmsg = "unexpected exception";
+  }
+
+  snd_.post(boost::bind(&coroutine_stackful_actor::resume, this, actor_normal, false));
+}
+///----------------------------------------------------------------------------
 void coroutine_stackful_actor::free_self()
 {
   aid_t self_aid = get_aid();
@@ -262,7 +368,7 @@ void coroutine_stackful_actor::stop(exit_code_t ec, std::string exit_msg)
   if (ec == exit_normal)
   {
     /// Trigger a context switching, ensure we stop coro using coroutine_stackful_actor::resume.
-    snd_.post(boost::bind(&coroutine_stackful_actor::resume, this, actor_normal));
+    snd_.post(boost::bind(&coroutine_stackful_actor::resume, this, actor_normal, false));
     yield();
   }
 
@@ -297,6 +403,7 @@ void coroutine_stackful_actor::handle_recv(detail::pack& pk)
   if (check(pk.recver_, ctxid_, timestamp_))
   {
     bool is_response = false;
+    bool is_exit = false;
 
     if (aid_t* aid = boost::get<aid_t>(&pk.tag_))
     {
@@ -313,6 +420,7 @@ void coroutine_stackful_actor::handle_recv(detail::pack& pk)
     }
     else if (detail::exit_t* ex = boost::get<detail::exit_t>(&pk.tag_))
     {
+      is_exit = true;
       mb_.push(*ex, pk.msg_);
       base_type::remove_link(ex->get_aid());
     }
@@ -322,6 +430,26 @@ void coroutine_stackful_actor::handle_recv(detail::pack& pk)
       mb_.push(*res, pk.msg_);
     }
 
+    if (res_gather_.waiting())
+    {
+      if (is_response || is_exit)
+      {
+        std::size_t n =
+          is_response ?
+            base_type::pop_response(res_gather_, boost::get<response_t>(pk.tag_)) :
+            base_type::pop_responses(res_gather_);
+        if (res_gather_.ready(n))
+        {
+          /// Resume after this drain, so answers queued behind come along.
+          ++tmr_sid_;
+          errcode_t ec;
+          tmr_.cancel(ec);
+          snd_.post(boost::bind(&coroutine_stackful_actor::resume, this, actor_normal, false));
+        }
+      }
+      return;
+    }
+
     if (
       (recving_ && !is_response) ||
       (responsing_ && is_response)
@@ -329,7 +457,7 @@ void coroutine_stackful_actor::handle_recv(detail::pack& pk)
     {
       if (recving_ && !is_response)
       {
-        bool ret = mb_.pop(recving_rcv_, recving_msg_, curr_match_.match_list_);
+        bool ret = base_type::pop_msg(recving_rcv_, recving_msg_, curr_match_);
         if (!ret)
         {
           return;
@@ -350,7 +478,7 @@ void coroutine_stackful_actor::handle_recv(detail::pack& pk)
       ++tmr_sid_;
       errcode_t ec;
       tmr_.cancel(ec);
-      resume(actor_normal);
+      resume(actor_normal, true);
     }
   }
   else if (!pk.is_err_ret_)
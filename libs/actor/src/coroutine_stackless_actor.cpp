@@ -17,14 +17,18 @@
 #include <gce/detail/scope.hpp>
 #include <boost/asio/placeholders.hpp>
 #include <boost/variant/get.hpp>
+#include <boost/move/utility.hpp>
 
 namespace gce
 {
 ///----------------------------------------------------------------------------
 coroutine_stackless_actor::coroutine_stackless_actor(detail::cache_pool* user)
-  : base_type(&user->get_context(), user, user->get_index())
+  : base_type(
+      &user->get_context(), user,
+      user->get_index(), user->per_actor_strand()
+      )
   , stat_(ready)
-  , tmr_(ctx_->get_io_service())
+  , tmr_(user_->get_io_service())
   , tmr_sid_(0)
 {
 }
@@ -49,7 +53,7 @@ aid_t coroutine_stackless_actor::recv(message& msg, match_list_t const& match_li
   aid_t sender;
   detail::recv_t rcv;
 
-  if (mb_.pop(rcv, msg, match_list))
+  if (base_type::pop_msg(rcv, msg, match_list))
   {
     sender = end_recv(rcv, msg);
   }
@@ -81,6 +85,36 @@ aid_t coroutine_stackless_actor::recv(response_t res, message& msg)
   return sender;
 }
 ///----------------------------------------------------------------------------
+void coroutine_stackless_actor::recv_batch(
+  msg_batch_t& batch, std::size_t max_n, match const& mach
+  )
+{
+  recv_batch(
+    boost::bind(
+      &coroutine_stackless_actor::wait_handler, this, _1
+      ),
+    batch, max_n, mach
+    );
+}
+///----------------------------------------------------------------------------
+void coroutine_stackless_actor::recv_responses(
+  response_list_t& pending, res_batch_t& batch, duration_t tmo, bool all
+  )
+{
+  std::size_t n = base_type::pop_responses(pending, batch);
+  if (pending.empty() || (n > 0 && !all) || tmo <= zero)
+  {
+    snd_.post(boost::bind(&coroutine_stackless_actor::run, this));
+    return;
+  }
+
+  if (tmo < infin)
+  {
+    start_responses_timer(tmo);
+  }
+  res_gather_.start(pending, batch, all);
+}
+///----------------------------------------------------------------------------
 void coroutine_stackless_actor::wait(duration_t dur)
 {
   wait(
@@ -91,6 +125,16 @@ void coroutine_stackless_actor::wait(duration_t dur)
     );
 }
 ///----------------------------------------------------------------------------
+void coroutine_stackless_actor::offload(offload_func_t const& f)
+{
+  offload(
+    f,
+    boost::bind(
+      &coroutine_stackless_actor::wait_handler, this, _1
+      )
+    );
+}
+///----------------------------------------------------------------------------
 void coroutine_stackless_actor::recv(
   coroutine_stackless_actor::recv_handler_t const& f, match const& mach
   )
@@ -98,8 +142,10 @@ void coroutine_stackless_actor::recv(
   aid_t sender;
   detail::recv_t rcv;
   message msg;
+  match tmp;
+  match const& filter = base_type::filter_match(mach, tmp);
 
-  if (!mb_.pop(rcv, msg, mach.match_list_))
+  if (!base_type::pop_msg(rcv, msg, filter))
   {
     duration_t tmo = mach.timeout_;
     if (tmo > zero)
@@ -109,7 +155,7 @@ void coroutine_stackless_actor::recv(
         start_recv_timer(tmo, f);
       }
       recv_h_ = f;
-      curr_match_ = mach;
+      curr_match_ = filter;
       return;
     }
   }
@@ -155,12 +201,38 @@ void coroutine_stackless_actor::recv(
     );
 }
 ///----------------------------------------------------------------------------
+void coroutine_stackless_actor::recv_batch(
+  wait_handler_t const& hdr, msg_batch_t& batch, 
+  std::size_t max_n, match const& mach
+  )
+{
+  BOOST_ASSERT(max_n > 0);
+  recv(
+    boost::bind(
+      &coroutine_stackless_actor::batch_handler, this, _1, _2, _3,
+      boost::ref(batch), max_n, mach, hdr
+      ),
+    mach
+    );
+}
+///----------------------------------------------------------------------------
 void coroutine_stackless_actor::wait(wait_handler_t const& f, duration_t dur)
 {
   start_wait_timer(dur, f);
   wait_h_ = f;
 }
 ///----------------------------------------------------------------------------
+void coroutine_stackless_actor::offload(
+  offload_func_t const& f, wait_handler_t const& hdr
+  )
+{
+  ctx_->post_blocking(
+    boost::bind(
+      &coroutine_stackless_actor::run_offload, this, f, hdr
+      )
+    );
+}
+///----------------------------------------------------------------------------
 void coroutine_stackless_actor::quit(exit_code_t exc, std::string const& errmsg)
 {
   aid_t self_aid = get_aid();
@@ -189,6 +261,7 @@ void coroutine_stackless_actor::on_free()
   f_.clear();
   coro_ = detail::coro_t();
   curr_match_.clear();
+  res_gather_.clear();
 
   recv_h_.clear();
   res_h_.clear();
@@ -198,22 +271,7 @@ void coroutine_stackless_actor::on_free()
 ///----------------------------------------------------------------------------
 void coroutine_stackless_actor::on_recv(detail::pack& pk, base_type::send_hint hint)
 {
-  if (hint == base_type::sync)
-  {
-    snd_.dispatch(
-      boost::bind(
-        &coroutine_stackless_actor::handle_recv, this, pk
-        )
-      );
-  }
-  else
-  {
-    snd_.post(
-      boost::bind(
-        &coroutine_stackless_actor::handle_recv, this, pk
-        )
-      );
-  }
+  base_type::push_inbox(pk, hint);
 }
 ///----------------------------------------------------------------------------
 void coroutine_stackless_actor::spawn_handler(self_ref_t, aid_t sender, aid_t& osender)
@@ -224,6 +282,7 @@ void coroutine_stackless_actor::spawn_handler(self_ref_t, aid_t sender, aid_t& o
 ///----------------------------------------------------------------------------
 void coroutine_stackless_actor::run()
 {
+  detail::watchdog::scope wdg_scp(wdg_, get_aid(), match_nil);
   try
   {
     actor<stackless> aref(*this);
@@ -285,6 +344,67 @@ void coroutine_stackless_actor::start_wait_timer(duration_t dur, wait_handler_t
     );
 }
 ///----------------------------------------------------------------------------
+void coroutine_stackless_actor::start_responses_timer(duration_t dur)
+{
+  tmr_.expires_from_now(dur);
+  tmr_.async_wait(
+    snd_.wrap(
+      boost::bind(
+        &coroutine_stackless_actor::handle_responses_timeout, this,
+        boost::asio::placeholders::error, ++tmr_sid_
+        )
+      )
+    );
+}
+///----------------------------------------------------------------------------
+void coroutine_stackless_actor::run_offload(
+  offload_func_t const& f, wait_handler_t const& hdr
+  )
+{
+  /// In a blocking thread.
+  boost::optional<std::string> errmsg;
+  try
+  {
+    ctx_->check_blocking();
+    f();
+  }
+  catch (std::exception& ex)
+  {
+    errmsg = ex.what();
+  }
+  catch (...)
+  {
+    errmsg = "unexpected exception";
+  }
+
+  snd_.post(
+    boost::bind(
+      &coroutine_stackless_actor::handle_offload, this, errmsg, hdr
+      )
+    );
+}
+///----------------------------------------------------------------------------
+void coroutine_stackless_actor::handle_offload(
+  boost::optional<std::string> const& errmsg, wait_handler_t const& hdr
+  )
+{
+  if (errmsg)
+  {
+    quit(exit_except, *errmsg);
+    return;
+  }
+
+  try
+  {
+    actor<stackless> aref(*this);
+    hdr(aref);
+  }
+  catch (std::exception& ex)
+  {
+    quit(exit_except, ex.what());
+  }
+}
+///----------------------------------------------------------------------------
 void coroutine_stackless_actor::handle_recv_timeout(
   errcode_t const& ec, std::size_t tmr_sid, recv_handler_t const& hdr
   )
@@ -347,11 +467,29 @@ void coroutine_stackless_actor::handle_wait_timeout(
   }
 }
 ///----------------------------------------------------------------------------
+void coroutine_stackless_actor::handle_responses_timeout(
+  errcode_t const& ec, std::size_t tmr_sid
+  )
+{
+  if (!ec && tmr_sid == tmr_sid_)
+  {
+    BOOST_ASSERT(res_gather_.waiting());
+    end_recv_responses();
+  }
+}
+///----------------------------------------------------------------------------
+void coroutine_stackless_actor::end_recv_responses()
+{
+  res_gather_.finish();
+  run();
+}
+///----------------------------------------------------------------------------
 void coroutine_stackless_actor::handle_recv(detail::pack& pk)
 {
   if (check(pk.recver_, get_aid().ctxid_, user_->get_context().get_timestamp()))
   {
     bool is_response = false;
+    bool is_exit = false;
 
     if (aid_t* aid = boost::get<aid_t>(&pk.tag_))
     {
@@ -368,6 +506,7 @@ void coroutine_stackless_actor::handle_recv(detail::pack& pk)
     }
     else if (detail::exit_t* ex = boost::get<detail::exit_t>(&pk.tag_))
     {
+      is_exit = true;
       mb_.push(*ex, pk.msg_);
       base_type::remove_link(ex->get_aid());
     }
@@ -377,6 +516,26 @@ void coroutine_stackless_actor::handle_recv(detail::pack& pk)
       mb_.push(*res, pk.msg_);
     }
 
+    if (res_gather_.waiting())
+    {
+      if (is_response || is_exit)
+      {
+        std::size_t n =
+          is_response ?
+            base_type::pop_response(res_gather_, boost::get<response_t>(pk.tag_)) :
+            base_type::pop_responses(res_gather_);
+        if (res_gather_.ready(n))
+        {
+          /// Resume after this drain, so answers queued behind come along.
+          ++tmr_sid_;
+          errcode_t ec;
+          tmr_.cancel(ec);
+          snd_.post(boost::bind(&coroutine_stackless_actor::end_recv_responses, this));
+        }
+      }
+      return;
+    }
+
     detail::recv_t rcv;
     message msg;
     aid_t sender;
@@ -389,7 +548,7 @@ void coroutine_stackless_actor::handle_recv(detail::pack& pk)
     {
       if (recv_h_ && !is_response)
       {
-        bool ret = mb_.pop(rcv, msg, curr_match_.match_list_);
+        bool ret = base_type::pop_msg(rcv, msg, curr_match_);
         if (!ret)
         {
           return;
@@ -477,10 +636,25 @@ void coroutine_stackless_actor::recv_handler(
   )
 {
   osender = sender;
-  omsg = msg;
+  omsg = boost::move(msg);
   run();
 }
 ///----------------------------------------------------------------------------
+void coroutine_stackless_actor::batch_handler(
+  self_ref_t self, aid_t sender, message msg, 
+  msg_batch_t& batch, std::size_t max_n, match const& mach,
+  wait_handler_t const& hdr
+  )
+{
+  if (sender)
+  {
+    batch.push_back(msg_batch_t::value_type(sender, message()));
+    batch.back().second = boost::move(msg);
+    base_type::pop_batch(batch, max_n - 1, mach);
+  }
+  hdr(self);
+}
+///----------------------------------------------------------------------------
 void coroutine_stackless_actor::wait_handler(self_ref_t)
 {
   run();
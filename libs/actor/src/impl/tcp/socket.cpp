@@ -8,11 +8,13 @@
 ///
 
 #include <gce/actor/impl/tcp/socket.hpp>
-#include <gce/actor/detail/cache_pool.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/asio/connect.hpp>
 #include <boost/asio/placeholders.hpp>
 #include <boost/bind.hpp>
+#ifdef __linux__
+# include <sys/socket.h>
+#endif
 
 namespace gce
 {
@@ -20,7 +22,7 @@ namespace tcp
 {
 ///----------------------------------------------------------------------------
 socket::socket(io_service_t& ios)
-  : user_(0)
+  : snd_(0)
   , reso_(ios)
   , sock_(ios)
   , closed_(false)
@@ -30,11 +32,12 @@ socket::socket(io_service_t& ios)
   , standby_buffer_(1)
   , sync_(ios)
   , waiting_end_(false)
+  , busy_poll_(0)
 {
 }
 ///----------------------------------------------------------------------------
 socket::socket(io_service_t& ios, std::string const& host, std::string const& port)
-  : user_(0)
+  : snd_(0)
   , reso_(ios)
   , sock_(ios)
   , host_(host)
@@ -46,6 +49,7 @@ socket::socket(io_service_t& ios, std::string const& host, std::string const& po
   , standby_buffer_(1)
   , sync_(ios)
   , waiting_end_(false)
+  , busy_poll_(0)
 {
 }
 ///----------------------------------------------------------------------------
@@ -53,19 +57,27 @@ socket::~socket()
 {
 }
 ///----------------------------------------------------------------------------
-void socket::init(gce::detail::cache_pool* user)
+void socket::init(strand_t& snd, net_option const& opt)
 {
-  user_ = user;
+  snd_ = &snd;
+  busy_poll_ = opt.busy_poll_;
+  if (sock_.is_open())
+  {
+    /// accepted
+    set_busy_poll();
+  }
 }
 ///----------------------------------------------------------------------------
 void socket::send(
   byte_t const* header, std::size_t header_size,
-  byte_t const* body, std::size_t body_size
+  byte_t const* body, std::size_t body_size,
+  bool urgent
   )
 {
   if (!waiting_end_)
   {
-    gce::detail::bytes_t& send_buf = send_buffer_[standby_buffer_];
+    gce::detail::bytes_t& send_buf =
+      urgent ? urgent_buffer_[standby_buffer_] : send_buffer_[standby_buffer_];
     send_buf.append(header, header_size);
     send_buf.append(body, body_size);
 
@@ -95,6 +107,10 @@ void socket::connect(yield_t yield)
     return;
   }
   boost::asio::async_connect(sock_, itr, yield);
+  if (!yield.ec_ || !*yield.ec_)
+  {
+    set_busy_poll();
+  }
 }
 ///----------------------------------------------------------------------------
 void socket::close()
@@ -128,16 +144,36 @@ void socket::close_socket()
   sock_.close(ignore_ec);
 }
 ///----------------------------------------------------------------------------
+void socket::set_busy_poll()
+{
+#ifdef SO_BUSY_POLL
+  if (busy_poll_ > 0)
+  {
+    int val = (int)busy_poll_;
+    ::setsockopt(
+      sock_.native_handle(), SOL_SOCKET, SO_BUSY_POLL,
+      (char const*)&val, sizeof(val)
+      );
+  }
+#endif
+}
+///----------------------------------------------------------------------------
 void socket::begin_send()
 {
   sending_ = true;
-  strand_t& snd = user_->get_strand();
+  strand_t& snd = *snd_;
   std::swap(sending_buffer_, standby_buffer_);
+  gce::detail::bytes_t const& urgent = urgent_buffer_[sending_buffer_];
   gce::detail::bytes_t const& bytes = send_buffer_[sending_buffer_];
+  boost::array<boost::asio::const_buffer, 2> buffers =
+  {{
+    boost::asio::buffer(urgent.data(), urgent.size()),
+    boost::asio::buffer(bytes.data(), bytes.size())
+  }};
 
   boost::asio::async_write(
     sock_,
-    boost::asio::buffer(bytes.data(), bytes.size()),
+    buffers,
     snd.wrap(
       boost::bind(
         &socket::end_send, this,
@@ -151,8 +187,13 @@ void socket::end_send(errcode_t const& errc)
 {
   sending_ = false;
   send_buffer_[sending_buffer_].clear();
+  urgent_buffer_[sending_buffer_].clear();
 
-  if (!errc && !send_buffer_[standby_buffer_].empty())
+  if (
+    !errc &&
+    (!send_buffer_[standby_buffer_].empty() ||
+    !urgent_buffer_[standby_buffer_].empty())
+    )
   {
     begin_send();
   }
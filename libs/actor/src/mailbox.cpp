@@ -1,42 +1,66 @@
-﻿///
-/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
-///
-/// Distributed under the Boost Software License, Version 1.0. (See accompanying
-/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
-///
-/// See https://github.com/nousxiong/gce for latest version.
-///
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
 
 #include <gce/actor/detail/mailbox.hpp>
 #include <gce/actor/match.hpp>
-#include <gce/detail/scope.hpp>
 #include <boost/foreach.hpp>
-#include <boost/bind.hpp>
+#include <boost/move/utility.hpp>
+#include <algorithm>
 
 namespace gce
 {
 namespace detail
 {
+/// Max freed nodes a mailbox keeps for reuse.
+static std::size_t const free_node_max = 256;
 ///------------------------------------------------------------------------------
-mailbox::mailbox(std::size_t cache_match_size)
-  : cache_match_list_(cache_match_size)
+mailbox::mailbox(
+  match_index& index, std::size_t cache_match_size,
+  boost::atomic_size_t& shed_num
+  )
+  : index_(index)
+  , shed_num_(shed_num)
+  , size_(0)
+  , match_queue_list_(cache_match_size)
+  , free_list_(0)
+  , free_num_(0)
 {
 }
 ///------------------------------------------------------------------------------
 mailbox::~mailbox()
 {
+  clear();
+  while (free_list_)
+  {
+    node* n = free_list_;
+    free_list_ = n->next_;
+    delete n;
+  }
 }
 ///------------------------------------------------------------------------------
 void mailbox::clear()
 {
-  recv_que_.clear();
-  BOOST_FOREACH(match_queue_t& que, cache_match_list_)
+  BOOST_FOREACH(recv_queue_t& que, recv_que_list_)
   {
-    que.clear();
+    while (!que.empty())
+    {
+      node* n = que.head_;
+      que.erase(n);
+      free_node(n);
+    }
   }
-  match_queue_list_.clear();
+  std::fill(match_queue_list_.begin(), match_queue_list_.end(), match_queue_t());
+  size_ = 0;
 
+  sender_list_.clear();
   res_msg_list_.clear();
+  discard_list_.clear();
   wait_reply_list_.clear();
   exit_list_.clear();
   svc_exit_list_.clear();
@@ -44,15 +68,41 @@ void mailbox::clear()
 ///------------------------------------------------------------------------------
 bool mailbox::pop(recv_t& src, message& msg, match_list_t const& match_list)
 {
-  if (recv_que_.empty())
+  while (take(src, msg, match_list))
   {
-    return false;
+    if (!shed(src))
+    {
+      return true;
+    }
   }
-
+  return false;
+}
+///------------------------------------------------------------------------------
+bool mailbox::pop(recv_t& src, message& msg, match const& mach)
+{
+  while (take(src, msg, mach))
+  {
+    if (!shed(src))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+///------------------------------------------------------------------------------
+bool mailbox::take(recv_t& src, message& msg, match_list_t const& match_list)
+{
   if (match_list.empty())
   {
-    recv_pair_t& rp = recv_que_.front();
-    return fetch_match_msg(rp.second.get_type(), src, msg);
+    BOOST_FOREACH(recv_queue_t& que, recv_que_list_)
+    {
+      if (!que.empty())
+      {
+        fetch(que.head_, src, msg);
+        return true;
+      }
+    }
+    return false;
   }
 
   BOOST_FOREACH(match_t type, match_list)
@@ -66,14 +116,82 @@ bool mailbox::pop(recv_t& src, message& msg, match_list_t const& match_list)
   return false;
 }
 ///------------------------------------------------------------------------------
+bool mailbox::take(recv_t& src, message& msg, match const& mach)
+{
+  if (!mach.from_ && !mach.svc_ && mach.pred_.empty())
+  {
+    return take(src, msg, mach.match_list_);
+  }
+
+  match_list_t const& match_list = mach.match_list_;
+  if (std::find(match_list.begin(), match_list.end(), exit) != match_list.end())
+  {
+    if (fetch_exit(src, msg))
+    {
+      return true;
+    }
+  }
+
+  if (mach.from_)
+  {
+    if (sender_queue_t* que = sender_list_.find(mach.from_))
+    {
+      for (node* n = que->head_; n; n = n->sender_next_)
+      {
+        if (accept(n, mach, true))
+        {
+          fetch(n, src, msg);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  if (match_list.empty())
+  {
+    BOOST_FOREACH(recv_queue_t& que, recv_que_list_)
+    {
+      for (node* n = que.head_; n; n = n->next_)
+      {
+        if (accept(n, mach, false))
+        {
+          fetch(n, src, msg);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  BOOST_FOREACH(match_t type, match_list)
+  {
+    std::size_t id = index_.find(type);
+    if (id >= match_queue_list_.size())
+    {
+      continue;
+    }
+
+    for (node* n = match_queue_list_[id].head_; n; n = n->match_next_)
+    {
+      if (n->msg_.get_type() == type && accept(n, mach, false))
+      {
+        fetch(n, src, msg);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+///------------------------------------------------------------------------------
 bool mailbox::pop(response_t& res, message& msg)
 {
-  res_msg_list_t::iterator itr(res_msg_list_.find(res.get_id()));
-  if (itr != res_msg_list_.end())
+  if (res_msg_pair_t* pr = res_msg_list_.find(res.get_id()))
   {
-    res = itr->second.first;
-    msg = itr->second.second;
-    res_msg_list_.erase(itr);
+    res = pr->first;
+    msg = boost::move(pr->second);
+    res_msg_list_.erase(res.get_id());
     return true;
   }
   else
@@ -85,8 +203,7 @@ bool mailbox::pop(response_t& res, message& msg)
       exit_list_t::iterator itr(exit_list_.find(recver));
       if (itr != exit_list_.end())
       {
-        recv_itr rtr = *itr->second;
-        msg = rtr->second;
+        msg = itr->second->msg_;
         res = response_t(res.get_id(), recver);
         return true;
       }
@@ -96,8 +213,7 @@ bool mailbox::pop(response_t& res, message& msg)
       svc_exit_list_t::iterator itr(svc_exit_list_.find(svc));
       if (itr != svc_exit_list_.end())
       {
-        recv_itr rtr = *itr->second.second;
-        msg = rtr->second;
+        msg = itr->second.second->msg_;
         res = response_t(res.get_id(), itr->second.first);
         return true;
       }
@@ -109,157 +225,409 @@ bool mailbox::pop(response_t& res, message& msg)
 ///------------------------------------------------------------------------------
 bool mailbox::pop(aid_t aid, request_t& req)
 {
-  wait_reply_list_t::iterator itr(wait_reply_list_.find(aid));
-  if (itr != wait_reply_list_.end())
+  if (req_queue_t* req_que = wait_reply_list_.find(aid))
   {
-    req_queue_t& req_que = itr->second;
-    if (!req_que.empty())
+    BOOST_ASSERT(!req_que->empty());
+    req = req_que->front();
+    req_que->pop_front();
+    if (req_que->empty())
     {
-      req = req_que.front();
-      req_que.pop_front();
+      wait_reply_list_.erase(aid);
+    }
+    return true;
+  }
+  return false;
+}
+///------------------------------------------------------------------------------
+bool mailbox::drop_oldest(recv_t& src, message& msg)
+{
+  for (std::size_t lane=prio_num-1; lane>prio_system; --lane)
+  {
+    /// An exit may sit here behind its sender's msgs; keep it, links rely
+    /// on it and exit_list_ points to it.
+    node* n = recv_que_list_[lane].head_;
+    while (n && n->msg_.get_type() == exit)
+    {
+      n = n->next_;
+    }
+
+    if (n)
+    {
+      src = n->rcv_;
+      msg = boost::move(n->msg_);
+      if (request_t* req = boost::get<request_t>(&src))
+      {
+        remove_request(*req);
+      }
+      remove(n);
       return true;
     }
   }
   return false;
 }
 ///------------------------------------------------------------------------------
-void mailbox::push(aid_t sender, message const& msg)
+bool mailbox::shed(recv_t const& src)
 {
-  recv_t rcv(sender);
-  scope scp(boost::bind(&recv_queue_t::pop_back, &recv_que_));
-  add_match_msg(rcv, sender, msg);
-  scp.reset();
+  request_t const* req = boost::get<request_t>(&src);
+  if (req && req->expired())
+  {
+    remove_request(*req);
+    shed_num_.fetch_add(1, boost::memory_order_relaxed);
+    return true;
+  }
+  return false;
 }
 ///------------------------------------------------------------------------------
-void mailbox::push(exit_t ex, message const& msg)
+void mailbox::remove_request(request_t const& req)
 {
-  recv_t rcv(ex);
-  scope scp(boost::bind(&recv_queue_t::pop_back, &recv_que_));
-  add_match_msg(rcv, ex.get_aid(), msg);
-  scp.reset();
+  /// A reply may already have consumed this sender's wait entry.
+  req_queue_t* req_que = wait_reply_list_.find(req.get_aid());
+  if (!req_que)
+  {
+    return;
+  }
+
+  for (req_queue_t::iterator itr(req_que->begin()); itr != req_que->end(); ++itr)
+  {
+    if (itr->get_id() == req.get_id())
+    {
+      req_que->erase(itr);
+      break;
+    }
+  }
+
+  if (req_que->empty())
+  {
+    wait_reply_list_.erase(req.get_aid());
+  }
 }
 ///------------------------------------------------------------------------------
-void mailbox::push(request_t req, message const& msg)
+void mailbox::push(aid_t sender, message& msg)
 {
-  scope scp(boost::bind(&recv_queue_t::pop_back, &recv_que_));
-  recv_t rcv(req);
-  add_match_msg(rcv, aid_t(), msg);
-  std::pair<wait_reply_list_t::iterator, bool> pr =
-    wait_reply_list_.insert(std::make_pair(req.get_aid(), dummy_));
-  pr.first->second.push_back(req);
-  scp.reset();
+  add_match_msg(recv_t(sender), sender, msg);
 }
 ///------------------------------------------------------------------------------
-bool mailbox::push(response_t res, message const& msg)
+void mailbox::push(exit_t ex, message& msg)
 {
-  res_msg_list_.insert(std::make_pair(res.get_id(), std::make_pair(res, msg)));
-  return false;
+  add_match_msg(recv_t(ex), ex.get_aid(), msg);
 }
 ///------------------------------------------------------------------------------
-void mailbox::add_match_msg(recv_t const& rcv, aid_t sender, message const& msg)
+void mailbox::push(request_t req, message& msg)
 {
-  recv_itr itr = recv_que_.insert(recv_que_.end(), std::make_pair(rcv, msg));
-  match_t type = msg.get_type();
-  match_itr mtr;
-  match_queue_t* match_que = 0;
+  if (req.expired())
+  {
+    shed_num_.fetch_add(1, boost::memory_order_relaxed);
+    return;
+  }
 
-  if (type >= 0 && type < (match_t)cache_match_list_.size())
+  req_queue_t& req_que = wait_reply_list_[req.get_aid()];
+  req_que.push_back(req);
+  try
   {
-    match_que = &cache_match_list_[type];
+    add_match_msg(recv_t(req), aid_t(), msg);
   }
-  else
+  catch (...)
+  {
+    req_que.pop_back();
+    if (req_que.empty())
+    {
+      wait_reply_list_.erase(req.get_aid());
+    }
+    throw;
+  }
+}
+///------------------------------------------------------------------------------
+bool mailbox::push(response_t res, message& msg)
+{
+  if (discard_list_.erase(res.get_id()))
   {
-    std::pair<match_queue_list_t::iterator, bool> pr =
-      match_queue_list_.insert(std::make_pair(type, dummy2_));
-    match_que = &pr.first->second;
+    return false;
   }
-  mtr = match_que->insert(match_que->end(), itr);
 
-  if (sender && type == exit)
+  res_msg_pair_t& pr = res_msg_list_[res.get_id()];
+  if (!pr.first.valid())
+  {
+    pr.first = res;
+    pr.second = boost::move(msg);
+  }
+  return false;
+}
+///------------------------------------------------------------------------------
+void mailbox::discard(response_t res)
+{
+  if (res_msg_list_.find(res.get_id()))
+  {
+    res_msg_list_.erase(res.get_id());
+  }
+  else
   {
-    if (sender.svc_)
+    discard_list_[res.get_id()] = true;
+  }
+}
+///------------------------------------------------------------------------------
+void mailbox::add_match_msg(recv_t const& rcv, aid_t sender, message& msg)
+{
+  node* n = make_node(rcv, msg);
+  try
+  {
+    if (n->id_ >= match_queue_list_.size())
     {
-      std::pair<aid_t, match_itr> p = std::make_pair(sender, mtr);
-      std::pair<svc_exit_list_t::iterator, bool> pr = 
-        svc_exit_list_.insert(std::make_pair(sender.svc_, p));
-      if (!pr.second)
-      {
-        recv_que_.erase(*pr.first->second.second);
-        match_que->erase(pr.first->second.second);
-        pr.first->second = p;
-      }
+      match_queue_list_.resize(n->id_ + 1);
     }
-    else
+    sender_list_.reserve(sender_list_.size() + 1);
+
+    if (sender && n->msg_.get_type() == exit)
     {
-      std::pair<exit_list_t::iterator, bool> pr = 
-        exit_list_.insert(std::make_pair(sender, mtr));
-      if (!pr.second)
-      {
-        recv_que_.erase(*pr.first->second);
-        match_que->erase(pr.first->second);
-        pr.first->second = mtr;
-      }
+      add_exit(sender, n);
     }
   }
+  catch (...)
+  {
+    free_node(n);
+    throw;
+  }
+
+  recv_que_list_[n->lane_].insert(0, n);
+  ++size_;
+  match_queue_list_[n->id_].insert_by_lane(n);
+  if (n->sender_)
+  {
+    /// Reserved above, no throw.
+    sender_list_[n->sender_].insert_by_lane(n);
+  }
 }
 ///------------------------------------------------------------------------------
-bool mailbox::fetch_match_msg(match_t type, recv_t& src, message& msg)
+void mailbox::add_exit(aid_t sender, node* n)
 {
-  match_queue_t* match_que = 0;
-  match_queue_list_t::iterator mq_itr(match_queue_list_.end());
-  if (type >= 0 && type < (match_t)cache_match_list_.size())
+  node* old = 0;
+  if (sender.svc_)
   {
-    match_que = &cache_match_list_[type];
+    std::pair<aid_t, node*> p = std::make_pair(sender, n);
+    std::pair<svc_exit_list_t::iterator, bool> pr =
+      svc_exit_list_.insert(std::make_pair(sender.svc_, p));
+    if (!pr.second)
+    {
+      old = pr.first->second.second;
+      pr.first->second = p;
+    }
   }
   else
   {
-    mq_itr = match_queue_list_.find(type);
-    if (mq_itr != match_queue_list_.end())
+    std::pair<exit_list_t::iterator, bool> pr =
+      exit_list_.insert(std::make_pair(sender, n));
+    if (!pr.second)
     {
-      match_que = &mq_itr->second;
+      old = pr.first->second;
+      pr.first->second = n;
     }
   }
 
-  if (match_que && !match_que->empty())
+  if (old)
+  {
+    /// Only the last exit msg of a sender is kept.
+    remove(old);
+  }
+}
+///------------------------------------------------------------------------------
+bool mailbox::fetch_match_msg(match_t type, recv_t& src, message& msg)
+{
+  std::size_t id = index_.find(type);
+  if (id >= match_queue_list_.size())
   {
-    recv_itr itr = match_que->front();
-    match_que->pop_front();
-    if (match_que->empty() && mq_itr != match_queue_list_.end())
+    return false;
+  }
+
+  /// Only the shared id 0 queue may hold other types.
+  node* n = match_queue_list_[id].head_;
+  while (n && n->msg_.get_type() != type)
+  {
+    n = n->match_next_;
+  }
+
+  if (n)
+  {
+    fetch(n, src, msg);
+    return true;
+  }
+
+  return false;
+}
+///------------------------------------------------------------------------------
+bool mailbox::fetch_exit(recv_t& src, message& msg)
+{
+  std::size_t id = index_.find(exit);
+  if (id >= match_queue_list_.size())
+  {
+    return false;
+  }
+
+  for (node* n = match_queue_list_[id].head_; n; n = n->match_next_)
+  {
+    if (n->msg_.get_type() == exit && !n->sender_prev_)
+    {
+      fetch(n, src, msg);
+      return true;
+    }
+  }
+  return false;
+}
+///------------------------------------------------------------------------------
+void mailbox::fetch(node* n, recv_t& src, message& msg)
+{
+  src = n->rcv_;
+  msg = boost::move(n->msg_);
+  if (msg.get_type() == exit)
+  {
+    aid_t sender;
+    if (aid_t* aid = boost::get<aid_t>(&src))
+    {
+      sender = *aid;
+    }
+    else if (exit_t* ex = boost::get<exit_t>(&src))
     {
-      match_queue_list_.erase(mq_itr);
+      sender = ex->get_aid();
     }
 
-    src = itr->first;
-    msg = itr->second;
-    if (type == exit)
+    if (sender)
     {
-      aid_t sender;
-      if (aid_t* aid = boost::get<aid_t>(&src))
+      if (sender.svc_)
       {
-        sender = *aid;
+        svc_exit_list_.erase(sender.svc_);
       }
-      else if (exit_t* ex = boost::get<exit_t>(&src))
+      else
       {
-        sender = ex->get_aid();
+        exit_list_.erase(sender);
       }
+    }
+  }
+  remove(n);
+}
+///------------------------------------------------------------------------------
+bool mailbox::accept(node* n, match const& mach, bool check_type) const
+{
+  match_list_t const& match_list = mach.match_list_;
+  if (
+    check_type && !match_list.empty() &&
+    std::find(match_list.begin(), match_list.end(), n->msg_.get_type()) == match_list.end()
+    )
+  {
+    return false;
+  }
 
-      if (sender)
-      {
-        if (sender.svc_)
-        {
-          svc_exit_list_.erase(sender.svc_);
-        }
-        else
-        {
-          exit_list_.erase(sender);
-        }
-      }
+  if (mach.svc_ && !mach.from_)
+  {
+    /// A remote service's msgs come from its ctx, tagged only on exit.
+    svcid_t const& svc = mach.svc_;
+    if (
+      n->sender_.svc_ != svc &&
+      (svc.ctxid_ == ctxid_nil || n->sender_.ctxid_ != svc.ctxid_)
+      )
+    {
+      return false;
     }
-    recv_que_.erase(itr);
-    return true;
   }
 
-  return false;
+  return mach.pred_.empty() || mach.pred_(n->sender_, n->msg_);
+}
+///------------------------------------------------------------------------------
+mailbox::node* mailbox::make_node(recv_t const& rcv, message& msg)
+{
+  node* n = free_list_;
+  if (n)
+  {
+    n->rcv_ = rcv;
+    n->msg_ = boost::move(msg);
+    free_list_ = n->next_;
+    n->next_ = 0;
+    --free_num_;
+  }
+  else
+  {
+    n = new node;
+    try
+    {
+      n->rcv_ = rcv;
+      n->msg_ = boost::move(msg);
+    }
+    catch (...)
+    {
+      delete n;
+      throw;
+    }
+  }
+
+  n->sender_ = get_sender(rcv);
+  n->lane_ = get_lane(n->msg_, n->sender_);
+  n->id_ = index_.get(n->msg_.get_type());
+  return n;
+}
+///------------------------------------------------------------------------------
+void mailbox::free_node(node* n)
+{
+  if (free_num_ >= free_node_max)
+  {
+    delete n;
+    return;
+  }
+
+  /// Drop the msg's payload now, not on reuse.
+  n->msg_ = message();
+  n->rcv_ = recv_t();
+  n->sender_ = aid_t();
+  n->prev_ = 0;
+  n->match_prev_ = 0;
+  n->match_next_ = 0;
+  n->sender_prev_ = 0;
+  n->sender_next_ = 0;
+  n->next_ = free_list_;
+  free_list_ = n;
+  ++free_num_;
+}
+///------------------------------------------------------------------------------
+void mailbox::remove(node* n)
+{
+  recv_que_list_[n->lane_].erase(n);
+  --size_;
+  match_queue_list_[n->id_].erase(n);
+  if (n->sender_)
+  {
+    sender_queue_t* que = sender_list_.find(n->sender_);
+    BOOST_ASSERT(que);
+    que->erase(n);
+    if (que->empty())
+    {
+      sender_list_.erase(n->sender_);
+    }
+  }
+  free_node(n);
+}
+///------------------------------------------------------------------------------
+std::size_t mailbox::get_lane(message const& msg, aid_t sender)
+{
+  if (msg.get_type() == exit)
+  {
+    /// Keep "send result, then quit" in order.
+    sender_queue_t* que = sender ? sender_list_.find(sender) : 0;
+    return que && !que->empty() ? que->tail_->lane_ : (std::size_t)prio_system;
+  }
+  return msg.get_priority();
+}
+///------------------------------------------------------------------------------
+aid_t mailbox::get_sender(recv_t const& rcv)
+{
+  if (aid_t const* aid = boost::get<aid_t>(&rcv))
+  {
+    return *aid;
+  }
+  else if (request_t const* req = boost::get<request_t>(&rcv))
+  {
+    return req->get_aid();
+  }
+  else if (exit_t const* ex = boost::get<exit_t>(&rcv))
+  {
+    return ex->get_aid();
+  }
+  return aid_t();
 }
 ///------------------------------------------------------------------------------
 }
@@ -0,0 +1,98 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#include <gce/actor/detail/match_index.hpp>
+#include <gce/actor/detail/flat_table.hpp>
+#include <gce/detail/cpu_relax.hpp>
+
+namespace gce
+{
+namespace detail
+{
+///------------------------------------------------------------------------------
+match_index::match_index(std::size_t size)
+  : mask_(1)
+  , next_id_(1)
+{
+  while (mask_ < size)
+  {
+    mask_ <<= 1;
+  }
+
+  key_list_.reset(new boost::atomic<match_t>[mask_]);
+  id_list_.reset(new boost::atomic_size_t[mask_]);
+  for (std::size_t i=0; i<mask_; ++i)
+  {
+    key_list_[i] = match_nil;
+    id_list_[i] = 0;
+  }
+  --mask_;
+}
+///------------------------------------------------------------------------------
+match_index::~match_index()
+{
+}
+///------------------------------------------------------------------------------
+std::size_t match_index::get(match_t type)
+{
+  return probe(type, true);
+}
+///------------------------------------------------------------------------------
+std::size_t match_index::find(match_t type) const
+{
+  return const_cast<match_index*>(this)->probe(type, false);
+}
+///------------------------------------------------------------------------------
+std::size_t match_index::probe(match_t type, bool insert)
+{
+  if (type == match_nil)
+  {
+    return 0;
+  }
+
+  std::size_t i = hash_mix(type) & mask_;
+  std::size_t probe_num = mask_ < max_probe ? mask_ + 1 : max_probe;
+  for (std::size_t n=0; n<probe_num; ++n, i=(i+1)&mask_)
+  {
+    match_t key = key_list_[i].load(boost::memory_order_acquire);
+    if (key == match_nil)
+    {
+      if (!insert)
+      {
+        /// Slots fill in probe order, type would be here or earlier.
+        return 0;
+      }
+
+      if (key_list_[i].compare_exchange_strong(key, type))
+      {
+        std::size_t id = next_id_.fetch_add(1, boost::memory_order_relaxed);
+        id_list_[i].store(id, boost::memory_order_release);
+        return id;
+      }
+      /// Lost the slot, key is the winner's type now.
+    }
+
+    if (key == type)
+    {
+      std::size_t id = id_list_[i].load(boost::memory_order_acquire);
+      while (id == 0)
+      {
+        /// The inserter is between its CAS and publishing the id.
+        cpu_relax();
+        id = id_list_[i].load(boost::memory_order_acquire);
+      }
+      return id;
+    }
+  }
+
+  return 0;
+}
+///------------------------------------------------------------------------------
+}
+}
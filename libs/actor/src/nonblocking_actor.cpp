@@ -17,6 +17,7 @@
 #include <boost/foreach.hpp>
 #include <boost/bind.hpp>
 #include <boost/variant/get.hpp>
+#include <boost/move/utility.hpp>
 
 namespace gce
 {
@@ -25,7 +26,7 @@ nonblocking_actor::nonblocking_actor(context& ctx, std::size_t index)
   : base_type(&ctx, ctx.select_cache_pool(), index)
   , cache_queue_list_(ctx_->get_cache_queue_size())
   , pack_queue_(1024)
-  , cac_pool_(ctx, index, true)
+  , cac_pool_(ctx, ctx.get_io_service(), index, true)
 {
   base_type::update_aid();
   user_ = &cac_pool_;
@@ -36,12 +37,18 @@ nonblocking_actor::~nonblocking_actor()
 }
 ///----------------------------------------------------------------------------
 aid_t nonblocking_actor::recv(message& msg, match_list_t const& match_list)
+{
+  return recv(msg, match(match_list, zero));
+}
+///----------------------------------------------------------------------------
+aid_t nonblocking_actor::recv(message& msg, match const& mach)
 {
   aid_t sender;
   detail::recv_t rcv;
 
   move_pack();
-  if (!mb_.pop(rcv, msg, match_list))
+  match tmp;
+  if (!mb_.pop(rcv, msg, base_type::filter_match(mach, tmp)))
   {
     return sender;
   }
@@ -63,6 +70,14 @@ aid_t nonblocking_actor::recv(message& msg, match_list_t const& match_list)
   return sender;
 }
 ///----------------------------------------------------------------------------
+std::size_t nonblocking_actor::recv_batch(
+  msg_batch_t& batch, std::size_t max_n, match const& mach
+  )
+{
+  move_pack();
+  return base_type::pop_batch(batch, max_n, mach);
+}
+///----------------------------------------------------------------------------
 aid_t nonblocking_actor::recv(response_t res, message& msg)
 {
   aid_t sender;
@@ -105,7 +120,7 @@ void nonblocking_actor::on_recv(detail::pack& pk, base_type::send_hint)
   }
 
   pk.cache_index_ = cac_que.index_base_++;
-  cac_que.que_.push_back(pk);
+  cac_que.que_.push_back(boost::move(pk));
   pack_queue_.push(&cac_que.que_.back());
 }
 ///------------------------------------------------------------------------------
@@ -119,7 +134,7 @@ void nonblocking_actor::register_service(match_t name, aid_t svc, std::size_t ca
 
   message m(detail::msg_reg_svc);
   m << name << svc;
-  pk.msg_ = m;
+  pk.msg_ = boost::move(m);
   on_recv(pk, base_type::sync);
 }
 ///------------------------------------------------------------------------------
@@ -133,7 +148,7 @@ void nonblocking_actor::deregister_service(match_t name, aid_t svc, std::size_t
 
   message m(detail::msg_dereg_svc);
   m << name << svc;
-  pk.msg_ = m;
+  pk.msg_ = boost::move(m);
   on_recv(pk, base_type::sync);
 }
 ///------------------------------------------------------------------------------
@@ -147,7 +162,7 @@ void nonblocking_actor::register_socket(ctxid_pair_t ctxid_pr, aid_t skt, std::s
 
   message m(detail::msg_reg_skt);
   m << ctxid_pr << skt;
-  pk.msg_ = m;
+  pk.msg_ = boost::move(m);
   on_recv(pk, base_type::sync);
 }
 ///------------------------------------------------------------------------------
@@ -161,7 +176,7 @@ void nonblocking_actor::deregister_socket(ctxid_pair_t ctxid_pr, aid_t skt, std:
 
   message m(detail::msg_dereg_skt);
   m << ctxid_pr << skt;
-  pk.msg_ = m;
+  pk.msg_ = boost::move(m);
   on_recv(pk, base_type::sync);
 }
 ///----------------------------------------------------------------------------
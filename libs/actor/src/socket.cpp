@@ -31,11 +31,13 @@ namespace detail
 {
 ///----------------------------------------------------------------------------
 socket::socket(cache_pool* user)
-  : basic_actor(&user->get_context(), user, user->get_index())
+  : basic_actor(
+      &user->get_context(), user, 
+      user->get_index(), user->per_actor_strand()
+      )
   , stat_(ready)
   , hb_(snd_)
-  , sync_(ctx_->get_io_service())
-  , recv_cache_(recv_buffer_, GCE_SOCKET_RECV_CACHE_SIZE)
+  , sync_(user_->get_io_service())
   , conn_(false)
   , curr_reconn_(0)
   , is_router_(false)
@@ -52,6 +54,12 @@ void socket::init(net_option opt)
   opt_ = opt;
   curr_reconn_ = u32_nil;
 
+  if (!recv_buffer_)
+  {
+    recv_buffer_.reset(new byte_t[GCE_SOCKET_RECV_CACHE_SIZE]);
+    recv_cache_.reset(recv_buffer_.get(), GCE_SOCKET_RECV_CACHE_SIZE);
+  }
+
   base_type::update_aid();
 }
 ///----------------------------------------------------------------------------
@@ -72,7 +80,7 @@ void socket::connect(
   user_->register_socket(ctxid_pr, get_aid());
 
   message m(msg_login);
-  m << ctxid_;
+  m << ctxid_ << msg::protocol_version;
   send(m);
 
   boost::asio::spawn(
@@ -124,11 +132,7 @@ void socket::on_free()
 ///----------------------------------------------------------------------------
 void socket::on_recv(pack& pk, base_type::send_hint)
 {
-  snd_.dispatch(
-    boost::bind(
-      &socket::handle_recv, this, pk
-      )
-    );
+  base_type::push_inbox(pk, base_type::sync);
 }
 ///----------------------------------------------------------------------------
 void socket::handle_net_msg(message& msg)
@@ -227,7 +231,7 @@ void socket::handle_net_msg(message& msg)
       else
       {
         context& ctx = user_->get_context();
-        cache_pool* user = ctx.select_cache_pool();
+        cache_pool* user = ctx.select_cache_pool(user_);
         user->get_strand().post(
           boost::bind(
             &socket::spawn_remote_actor, this,
@@ -318,7 +322,7 @@ void socket::spawn_remote_actor(cache_pool* user, spawn_t spw, remote_func f)
   {
     aid = make_stackless_actor(aid_t(), user, f.ef_, spw.get_stack_size());
   }
-  user_->get_strand().post(
+  snd_.post(
     boost::bind(
       &socket::end_spawn_remote_actor, this, spw, aid
       )
@@ -376,13 +380,15 @@ void socket::send_msg(message const& m)
   hdr.size_ = (boost::uint32_t)m.size();
   hdr.type_ = m.get_type();
   hdr.tag_offset_ = m.tag_offset_;
+  hdr.prio_ = (boost::uint8_t)m.get_priority();
 
   byte_t buf[sizeof(msg::header)];
   boost::amsg::zero_copy_buffer zbuf(buf, sizeof(msg::header));
   boost::amsg::write(zbuf, hdr);
   skt_->send(
     buf, zbuf.write_length(),
-    m.data(), hdr.size_
+    m.data(), hdr.size_,
+    m.get_priority() < prio_normal
     );
 }
 ///----------------------------------------------------------------------------
@@ -396,16 +402,33 @@ void send_ret(socket* s, aid_t sire, ctxid_pair_t ctxid_pr)
   gce::send(*s, sire, msg_new_conn, ctxid_pr);
 }
 ///----------------------------------------------------------------------------
+void check_protocol(message& m)
+{
+  boost::uint16_t ver = 0;
+  try
+  {
+    m >> ver;
+  }
+  catch (std::runtime_error&)
+  {
+    /// A peer from before versioning.
+  }
+
+  if (ver != msg::protocol_version)
+  {
+    throw std::runtime_error("protocol version mismatch");
+  }
+}
+///----------------------------------------------------------------------------
 void socket::run_conn(aid_t sire, ctxid_pair_t target, std::string const& ep, yield_t yield)
 {
   exit_code_t exc = exit_normal;
   std::string exit_msg("exit normal");
   ctxid_pair_t curr_pr = target;
 
-  if (!user_->stopped())
+  if (user_->add_socket(this))
   {
     context& ctx = user_->get_context();
-    user_->add_socket(this);
     ctx.register_socket(target, get_aid(), user_->get_index());
 
     try
@@ -446,6 +469,7 @@ void socket::run_conn(aid_t sire, ctxid_pair_t target, std::string const& ep, yi
           {
             ctxid_pair_t ctxid_pr;
             msg >> ctxid_pr;
+            check_protocol(msg);
             curr_pr = sync_ctxid(ctxid_pr, curr_pr);
           }
           else if (type != detail::msg_hb)
@@ -486,16 +510,15 @@ void socket::run(socket_ptr skt, yield_t yield)
       is_router_ ? socket_joint : socket_comm
       );
 
-  if (!user_->stopped())
+  if (user_->add_socket(this))
   {
     context& ctx = user_->get_context();
-    user_->add_socket(this);
 
     try
     {
       stat_ = on;
       skt_ = skt;
-      skt_->init(user_);
+      skt_->init(snd_, opt_);
       start_heartbeat(boost::bind(&socket::close, this));
 
       while (stat_ == on)
@@ -521,12 +544,14 @@ void socket::run(socket_ptr skt, yield_t yield)
                 is_router_ ? socket_joint : socket_comm
                 );
             msg >> ctxid_pr.first;
+            check_protocol(msg);
             curr_pr = sync_ctxid(ctxid_pr, curr_pr);
             message m(msg_login_ret);
             m << std::make_pair(
               ctxid_,
               is_router_ ? socket_router : socket_comm
               );
+            m << gce::msg::protocol_version;
             send(m);
           }
           else if (type != detail::msg_hb)
@@ -582,11 +607,11 @@ socket_ptr socket::make_socket(std::string const& ep)
     std::string port = ep.substr(begin, pos - begin);
     socket_ptr skt(
       new tcp::socket(
-        user_->get_strand().get_io_service(),
+        user_->get_io_service(),
         address, port
         )
       );
-    skt->init(user_);
+    skt->init(snd_, opt_);
     return skt;
   }
 
@@ -616,6 +641,12 @@ void socket::handle_recv(pack& pk)
       remove_router_link(ex->get_aid(), pk.recver_);
       pk.tag_ = exit_t(ex->get_code(), ex->get_aid());
     }
+
+    if (!boost::get<aid_t>(&pk.tag_) && !boost::get<request_t>(&pk.tag_))
+    {
+      /// Supervision, replies and spawns overtake bulk data.
+      pk.msg_.set_priority(prio_system);
+    }
     pk.msg_.push_tag(
       pk.tag_, pk.recver_, pk.svc_,
       pk.skt_, pk.is_err_ret_
@@ -777,6 +808,7 @@ bool socket::parse_message(message& msg)
 
   recv_cache_.read(header_size + hdr.size_);
   msg = message(hdr.type_, data + header_size, hdr.size_, hdr.tag_offset_);
+  msg.set_priority((priority_type)hdr.prio_);
 
   /// reset read_cache
   if (recv_cache_.read_size() > GCE_SOCKET_RECV_MAX_SIZE)
@@ -784,7 +816,7 @@ bool socket::parse_message(message& msg)
     BOOST_ASSERT(recv_cache_.write_size() >= recv_cache_.read_size());
     std::size_t copy_size =
       recv_cache_.write_size() - recv_cache_.read_size();
-    std::memmove(recv_buffer_, recv_cache_.get_read_data(), copy_size);
+    std::memmove(recv_buffer_.get(), recv_cache_.get_read_data(), copy_size);
     recv_cache_.clear();
     recv_cache_.write(copy_size);
   }
@@ -841,7 +873,7 @@ void socket::connect(yield_t yield, bool init)
     start_heartbeat(boost::bind(&socket::reconn, this));
 
     message m(msg_login);
-    m << ctxid_;
+    m << ctxid_ << msg::protocol_version;
     send(m);
   }
 }
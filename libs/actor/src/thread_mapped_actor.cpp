@@ -17,6 +17,7 @@
 #include <boost/foreach.hpp>
 #include <boost/bind.hpp>
 #include <boost/variant/get.hpp>
+#include <boost/move/utility.hpp>
 
 namespace gce
 {
@@ -25,7 +26,9 @@ thread_mapped_actor::thread_mapped_actor(detail::cache_pool* user)
   : base_type(&user->get_context(), user, user->get_index())
   , recv_p_(0)
   , res_p_(0)
-  , tmr_(ctx_->get_io_service())
+  , recv_batch_(0)
+  , batch_max_(0)
+  , tmr_(user_->get_io_service())
   , tmr_sid_(0)
 {
   base_type::update_aid();
@@ -39,7 +42,7 @@ void thread_mapped_actor::send(aid_t recver, message const& m)
 {
   snd_.post(
     boost::bind(
-      &base_type::pri_send, this, recver, m, base_type::sync
+      static_cast<pri_send_t>(&base_type::pri_send), this, recver, m, base_type::sync
       )
     );
 }
@@ -48,7 +51,7 @@ void thread_mapped_actor::send(svcid_t recver, message const& m)
 {
   snd_.post(
     boost::bind(
-      &base_type::pri_send_svc, this, recver, m, base_type::sync
+      static_cast<pri_send_svc_t>(&base_type::pri_send_svc), this, recver, m, base_type::sync
       )
     );
 }
@@ -57,7 +60,7 @@ void thread_mapped_actor::relay(aid_t des, message& m)
 {
   snd_.post(
     boost::bind(
-      &base_type::pri_relay, this, des, m, base_type::sync
+      static_cast<pri_relay_t>(&base_type::pri_relay), this, des, m, base_type::sync
       )
     );
 }
@@ -66,30 +69,30 @@ void thread_mapped_actor::relay(svcid_t des, message& m)
 {
   snd_.post(
     boost::bind(
-      &base_type::pri_relay_svc, this, des, m, base_type::sync
+      static_cast<pri_relay_svc_t>(&base_type::pri_relay_svc), this, des, m, base_type::sync
       )
     );
 }
 ///----------------------------------------------------------------------------
-response_t thread_mapped_actor::request(aid_t recver, message const& m)
+response_t thread_mapped_actor::request(aid_t recver, message const& m, duration_t tmo)
 {
   response_t res(base_type::new_request(), get_aid(), recver);
   snd_.post(
     boost::bind(
       &base_type::pri_request, this,
-      res, recver, m, base_type::sync
+      res, recver, m, tmo, base_type::sync
       )
     );
   return res;
 }
 ///----------------------------------------------------------------------------
-response_t thread_mapped_actor::request(svcid_t recver, message const& m)
+response_t thread_mapped_actor::request(svcid_t recver, message const& m, duration_t tmo)
 {
   response_t res(base_type::new_request(), get_aid(), recver);
   snd_.post(
     boost::bind(
       &base_type::pri_request_svc, this,
-      res, recver, m, base_type::sync
+      res, recver, m, tmo, base_type::sync
       )
     );
   return res;
@@ -99,7 +102,7 @@ void thread_mapped_actor::reply(aid_t recver, message const& m)
 {
   snd_.post(
     boost::bind(
-      &base_type::pri_reply, this, recver, m, base_type::sync
+      static_cast<pri_send_t>(&base_type::pri_reply), this, recver, m, base_type::sync
       )
     );
 }
@@ -181,6 +184,49 @@ aid_t thread_mapped_actor::recv(response_t res, message& msg, duration_t tmo)
   return sender;
 }
 ///----------------------------------------------------------------------------
+std::size_t thread_mapped_actor::recv_batch(
+  msg_batch_t& batch, std::size_t max_n, match const& mach
+  )
+{
+  if (max_n == 0)
+  {
+    return 0;
+  }
+
+  std::size_t old_size = batch.size();
+  recv_promise_t p;
+  recv_future_t f = p.get_future();
+
+  snd_.post(
+    boost::bind(
+      &thread_mapped_actor::try_recv_batch, this,
+      boost::ref(p), boost::ref(batch), max_n, boost::cref(mach)
+      )
+    );
+
+  f.wait();
+  return batch.size() - old_size;
+}
+///----------------------------------------------------------------------------
+std::size_t thread_mapped_actor::recv_responses(
+  response_list_t& pending, res_batch_t& batch, duration_t tmo, bool all
+  )
+{
+  std::size_t old_size = batch.size();
+  res_promise_t p;
+  res_future_t f = p.get_future();
+
+  snd_.post(
+    boost::bind(
+      &thread_mapped_actor::try_recv_responses, this,
+      boost::ref(p), boost::ref(pending), boost::ref(batch), tmo, all
+      )
+    );
+
+  f.wait();
+  return batch.size() - old_size;
+}
+///----------------------------------------------------------------------------
 void thread_mapped_actor::wait(duration_t dur)
 {
   boost::this_thread::sleep_for(dur);
@@ -188,22 +234,7 @@ void thread_mapped_actor::wait(duration_t dur)
 ///----------------------------------------------------------------------------
 void thread_mapped_actor::on_recv(detail::pack& pk, base_type::send_hint hint)
 {
-  if (hint == base_type::sync)
-  {
-    snd_.dispatch(
-      boost::bind(
-        &thread_mapped_actor::handle_recv, this, pk
-        )
-      );
-  }
-  else
-  {
-    snd_.post(
-      boost::bind(
-        &thread_mapped_actor::handle_recv, this, pk
-        )
-      );
-  }
+  base_type::push_inbox(pk, hint);
 }
 ///----------------------------------------------------------------------------
 sid_t thread_mapped_actor::spawn(
@@ -224,7 +255,10 @@ sid_t thread_mapped_actor::spawn(
 void thread_mapped_actor::try_recv(recv_promise_t& p, match const& mach)
 {
   std::pair<detail::recv_t, message> rcv;
-  if (!mb_.pop(rcv.first, rcv.second, mach.match_list_))
+  match tmp;
+  match const& filter = base_type::filter_match(mach, tmp);
+
+  if (!base_type::pop_msg(rcv.first, rcv.second, filter))
   {
     duration_t tmo = mach.timeout_;
     if (tmo > zero)
@@ -234,7 +268,7 @@ void thread_mapped_actor::try_recv(recv_promise_t& p, match const& mach)
         start_recv_timer(tmo, p);
       }
       recv_p_ = &p;
-      curr_match_ = mach;
+      curr_match_ = filter;
       return;
     }
   }
@@ -242,6 +276,26 @@ void thread_mapped_actor::try_recv(recv_promise_t& p, match const& mach)
   p.set_value(rcv);
 }
 ///----------------------------------------------------------------------------
+void thread_mapped_actor::try_recv_batch(
+  recv_promise_t& p, msg_batch_t& batch, std::size_t max_n, match const& mach
+  )
+{
+  /// batch is owned by the blocked caller until p is set.
+  if (base_type::pop_batch(batch, max_n, mach) > 0)
+  {
+    p.set_value(recv_optional_t());
+    return;
+  }
+
+  recv_batch_ = &batch;
+  batch_max_ = max_n;
+  try_recv(p, mach);
+  if (!recv_p_)
+  {
+    recv_batch_ = 0;
+  }
+}
+///----------------------------------------------------------------------------
 void thread_mapped_actor::try_response(res_promise_t& p, response_t res, duration_t tmo)
 {
   std::pair<response_t, message> res_pr;
@@ -263,6 +317,35 @@ void thread_mapped_actor::try_response(res_promise_t& p, response_t res, duratio
   p.set_value(res_pr);
 }
 ///----------------------------------------------------------------------------
+void thread_mapped_actor::try_recv_responses(
+  res_promise_t& p, response_list_t& pending, res_batch_t& batch,
+  duration_t tmo, bool all
+  )
+{
+  /// pending and batch are owned by the blocked caller until p is set.
+  std::size_t n = base_type::pop_responses(pending, batch);
+  if (pending.empty() || (n > 0 && !all) || tmo <= zero)
+  {
+    p.set_value(res_optional_t());
+    return;
+  }
+
+  if (tmo < infin)
+  {
+    start_recv_timer(tmo, p);
+  }
+  res_p_ = &p;
+  res_gather_.start(pending, batch, all);
+}
+///----------------------------------------------------------------------------
+void thread_mapped_actor::end_recv_responses()
+{
+  BOOST_ASSERT(res_p_);
+  res_gather_.finish();
+  res_p_->set_value(res_optional_t());
+  res_p_ = 0;
+}
+///----------------------------------------------------------------------------
 void thread_mapped_actor::start_recv_timer(duration_t dur, recv_promise_t& p)
 {
   tmr_.expires_from_now(dur);
@@ -298,6 +381,7 @@ void thread_mapped_actor::handle_recv_timeout(
     /// timed out
     BOOST_ASSERT(&p == recv_p_);
     recv_p_ = 0;
+    recv_batch_ = 0;
     curr_match_.clear();
     std::pair<detail::recv_t, message> rcv;
     p.set_value(rcv);
@@ -314,6 +398,7 @@ void thread_mapped_actor::handle_res_timeout(
     BOOST_ASSERT(&p == res_p_);
     res_p_ = 0;
     recving_res_ = response_t();
+    res_gather_.finish();
     std::pair<response_t, message> res_pr;
     p.set_value(res_pr);
   }
@@ -324,6 +409,7 @@ void thread_mapped_actor::handle_recv(detail::pack& pk)
   if (check(pk.recver_, ctxid_, timestamp_))
   {
     bool is_response = false;
+    bool is_exit = false;
 
     if (aid_t* aid = boost::get<aid_t>(&pk.tag_))
     {
@@ -340,6 +426,7 @@ void thread_mapped_actor::handle_recv(detail::pack& pk)
     }
     else if (detail::exit_t* ex = boost::get<detail::exit_t>(&pk.tag_))
     {
+      is_exit = true;
       mb_.push(*ex, pk.msg_);
       base_type::remove_link(ex->get_aid());
     }
@@ -349,6 +436,26 @@ void thread_mapped_actor::handle_recv(detail::pack& pk)
       mb_.push(*res, pk.msg_);
     }
 
+    if (res_gather_.waiting())
+    {
+      if (is_response || is_exit)
+      {
+        std::size_t n =
+          is_response ?
+            base_type::pop_response(res_gather_, boost::get<response_t>(pk.tag_)) :
+            base_type::pop_responses(res_gather_);
+        if (res_gather_.ready(n))
+        {
+          /// Wake caller after this drain, so answers queued behind come along.
+          ++tmr_sid_;
+          errcode_t ec;
+          tmr_.cancel(ec);
+          snd_.post(boost::bind(&thread_mapped_actor::end_recv_responses, this));
+        }
+      }
+      return;
+    }
+
     detail::recv_t rcv;
     message msg;
 
@@ -359,12 +466,25 @@ void thread_mapped_actor::handle_recv(detail::pack& pk)
     {
       if (recv_p_ && !is_response)
       {
-        bool ret = mb_.pop(rcv, msg, curr_match_.match_list_);
+        bool ret = base_type::pop_msg(rcv, msg, curr_match_);
         if (!ret)
         {
           return;
         }
-        recv_p_->set_value(std::make_pair(rcv, msg));
+
+        if (recv_batch_)
+        {
+          aid_t sender = base_type::get_sender(rcv, msg);
+          recv_batch_->push_back(msg_batch_t::value_type(sender, message()));
+          recv_batch_->back().second = boost::move(msg);
+          base_type::pop_batch(*recv_batch_, batch_max_ - 1, curr_match_);
+          recv_batch_ = 0;
+          recv_p_->set_value(recv_optional_t());
+        }
+        else
+        {
+          recv_p_->set_value(std::make_pair(rcv, msg));
+        }
         recv_p_ = 0;
         curr_match_.clear();
       }
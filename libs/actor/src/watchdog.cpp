@@ -0,0 +1,168 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+#include <gce/actor/detail/watchdog.hpp>
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <iostream>
+
+namespace gce
+{
+namespace detail
+{
+///------------------------------------------------------------------------------
+watchdog::watchdog(duration_t threshold, stall_callback_t const& cb)
+  : threshold_(threshold)
+  , cb_(cb)
+  , curr_slot_(&watchdog::no_cleanup)
+{
+  thr_ = boost::thread(boost::bind(&watchdog::run, this));
+}
+///------------------------------------------------------------------------------
+watchdog::~watchdog()
+{
+  thr_.interrupt();
+  thr_.join();
+}
+///------------------------------------------------------------------------------
+void watchdog::begin(aid_t aid, match_t type)
+{
+  slot& s = get_slot();
+  if (s.depth_++ == 0)
+  {
+    boost::mutex::scoped_lock lock(s.mtx_);
+    s.running_ = true;
+    s.reported_ = false;
+    s.begin_ = clock_t::now();
+    s.aid_ = aid;
+    s.type_ = type;
+  }
+}
+///------------------------------------------------------------------------------
+void watchdog::end()
+{
+  slot& s = get_slot();
+  BOOST_ASSERT(s.depth_ > 0);
+  if (--s.depth_ == 0)
+  {
+    duration_t dur;
+    aid_t aid;
+    match_t type;
+    bool reported;
+    {
+      boost::mutex::scoped_lock lock(s.mtx_);
+      s.running_ = false;
+      reported = s.reported_;
+      dur = boost::chrono::duration_cast<duration_t>(clock_t::now() - s.begin_);
+      aid = s.aid_;
+      type = s.type_;
+    }
+
+    if (!reported && dur > threshold_)
+    {
+      report(aid, type, dur);
+    }
+  }
+}
+///------------------------------------------------------------------------------
+watchdog::slot& watchdog::get_slot()
+{
+  slot* s = curr_slot_.get();
+  if (!s)
+  {
+    boost::shared_ptr<slot> new_slot(new slot);
+    {
+      boost::mutex::scoped_lock lock(slot_list_mtx_);
+      slot_list_.push_back(new_slot);
+    }
+    s = new_slot.get();
+    curr_slot_.reset(s);
+  }
+  return *s;
+}
+///------------------------------------------------------------------------------
+void watchdog::run()
+{
+  duration_t period = threshold_ / 2;
+  if (period < boost::chrono::milliseconds(1))
+  {
+    period = boost::chrono::milliseconds(1);
+  }
+
+  try
+  {
+    while (true)
+    {
+      boost::this_thread::sleep_for(period);
+
+      std::vector<boost::shared_ptr<slot> > slot_list;
+      {
+        boost::mutex::scoped_lock lock(slot_list_mtx_);
+        slot_list = slot_list_;
+      }
+
+      clock_t::time_point now = clock_t::now();
+      BOOST_FOREACH(boost::shared_ptr<slot> const& s, slot_list)
+      {
+        duration_t dur;
+        aid_t aid;
+        match_t type = match_nil;
+        {
+          boost::mutex::scoped_lock lock(s->mtx_);
+          if (!s->running_ || s->reported_)
+          {
+            continue;
+          }
+
+          dur = boost::chrono::duration_cast<duration_t>(now - s->begin_);
+          if (dur <= threshold_)
+          {
+            continue;
+          }
+          s->reported_ = true;
+          aid = s->aid_;
+          type = s->type_;
+        }
+        report(aid, type, dur);
+      }
+    }
+  }
+  catch (boost::thread_interrupted&)
+  {
+  }
+}
+///------------------------------------------------------------------------------
+void watchdog::no_cleanup(slot*)
+{
+  /// Slots are owned by slot_list_.
+}
+///------------------------------------------------------------------------------
+void watchdog::report(aid_t aid, match_t type, duration_t dur)
+{
+  try
+  {
+    if (cb_)
+    {
+      cb_(aid, type, dur);
+    }
+    else
+    {
+      std::cerr << "actor " << aid << " stalled " <<
+        boost::chrono::duration_cast<boost::chrono::milliseconds>(dur).count() <<
+        "ms on msg " << (type == match_nil ? std::string("nil") : atom(type)) <<
+        std::endl;
+    }
+  }
+  catch (...)
+  {
+  }
+}
+///------------------------------------------------------------------------------
+}
+}
@@ -18,6 +18,7 @@
 #include <boost/array.hpp>
 #include <boost/ref.hpp>
 #include <boost/assert.hpp>
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -48,6 +49,9 @@
 #include "test_remote_relay.hpp"
 #include "test_send_recv.hpp"
 #include "test_service.hpp"
+#include "test_sched.hpp"
+#include "test_offload.hpp"
+#include "test_mailbox_limit.hpp"
 
 int main()
 {
@@ -78,6 +82,9 @@ int main()
     gce::router_broken_ut::run();
     gce::remote_relay_ut::run();
     gce::service_ut::run();
+    gce::sched_ut::run();
+    gce::offload_ut::run();
+    gce::mailbox_limit_ut::run();
   }
   catch (std::exception& ex)
   {
@@ -16,6 +16,7 @@ public:
   {
     std::cout << "link_ut begin." << std::endl;
     test_common();
+    test_exit_fanout();
     std::cout << "link_ut end." << std::endl;
   }
 
@@ -100,6 +101,70 @@ public:
     }
   }
 
+  static void fanout_target(actor<stackful>& self, std::size_t watcher_num)
+  {
+    for (std::size_t i=0; i<watcher_num; ++i)
+    {
+      recv(self, 2);
+    }
+  }
+
+  static void fanout_watcher(actor<stackful>& self, aid_t target, aid_t base_id)
+  {
+    /// Link goes before the msg, both from self, so target sees it first.
+    self.monitor(target);
+    send(self, target, 2);
+
+    message msg;
+    self.recv(msg, match(exit));
+    exit_code_t ec = match_nil;
+    std::string reason;
+    try
+    {
+      msg >> ec >> reason;
+    }
+    catch (std::exception&)
+    {
+      ec = match_nil;
+    }
+    send(self, base_id, 3, ec, reason);
+  }
+
+  static void test_exit_fanout()
+  {
+    try
+    {
+      std::size_t const watcher_num = 3;
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t target =
+        spawn(base, boost::bind(&link_ut::fanout_target, _1, watcher_num));
+      for (std::size_t i=0; i<watcher_num; ++i)
+      {
+        spawn(
+          base,
+          boost::bind(&link_ut::fanout_watcher, _1, target, base.get_aid())
+          );
+      }
+
+      /// Every watcher decodes the same exit code and reason.
+      for (std::size_t i=0; i<watcher_num; ++i)
+      {
+        exit_code_t ec = 0;
+        std::string reason;
+        recv(base, 3, ec, reason);
+        BOOST_ASSERT(ec == exit_normal);
+        BOOST_ASSERT(!reason.empty());
+      }
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_exit_fanout except: " << ex.what() << std::endl;
+    }
+  }
+
   static void test_common()
   {
     try
@@ -0,0 +1,303 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+namespace gce
+{
+class mailbox_limit_ut
+{
+public:
+  static void run()
+  {
+    std::cout << "mailbox_limit_ut begin." << std::endl;
+    test_policy(overflow_drop_newest, 10, 11);
+    test_policy(overflow_drop_oldest, 11, 12);
+    test_policy(overflow_reject, 10, 11);
+    test_policy(overflow_block, 10, 11, 12);
+    test_threaded();
+    test_block_response();
+    test_block_cap();
+    test_drop_keeps_exit();
+    std::cout << "mailbox_limit_ut end." << std::endl;
+  }
+
+private:
+  static void limit_actor(
+    actor<stackful>& self, aid_t base_id,
+    overflow_policy policy, std::vector<match_t> expect,
+    std::size_t capacity
+    )
+  {
+    self.set_mailbox_limit(mailbox_limit(capacity, policy, base_id));
+    send(self, base_id, 1);
+
+    /// Let all msgs arrive first.
+    wait(self, boost::chrono::milliseconds(100));
+
+    message msg;
+    BOOST_FOREACH(match_t type, expect)
+    {
+      BOOST_ASSERT(self.recv(msg, match(seconds_t(1))));
+      BOOST_ASSERT(msg.get_type() == type);
+    }
+    BOOST_ASSERT(!self.recv(msg, match(zero)));
+
+    send(self, base_id, 2);
+  }
+
+  static void burst_actor(actor<stackful>& self, aid_t recver)
+  {
+    recv(self, 1);
+    for (match_t type=10; type<13; ++type)
+    {
+      self.send(recver, message(type));
+    }
+  }
+
+  static void echo_actor(actor<stackful>& self)
+  {
+    aid_t sender = recv(self, 20);
+    reply(self, sender, 21);
+  }
+
+  static void block_actor(actor<stackful>& self, aid_t base_id)
+  {
+    aid_t echo = spawn(self, boost::bind(&mailbox_limit_ut::echo_actor, _1));
+    self.set_mailbox_limit(mailbox_limit(2, overflow_block));
+    send(self, base_id, 1);
+
+    /// Let all msgs arrive first, 10 and 11 are queued, 12 held back.
+    wait(self, boost::chrono::milliseconds(100));
+
+    /// The response gets past them.
+    response_t res = request(self, echo, 20);
+    message msg;
+    BOOST_ASSERT(self.recv(res, msg, seconds_t(1)));
+    BOOST_ASSERT(msg.get_type() == 21);
+
+    for (match_t type=10; type<13; ++type)
+    {
+      BOOST_ASSERT(self.recv(msg, match(seconds_t(1))));
+      BOOST_ASSERT(msg.get_type() == type);
+    }
+    BOOST_ASSERT(!self.recv(msg, match(zero)));
+
+    send(self, base_id, 2);
+  }
+
+  static void exit_sender(actor<stackful>& self, aid_t recver)
+  {
+    recv(self, 3);
+    send(self, recver, 10);
+  }
+
+  static void exit_keep_actor(actor<stackful>& self, aid_t base_id)
+  {
+    aid_t sender =
+      spawn(self, boost::bind(&mailbox_limit_ut::exit_sender, _1, self.get_aid()));
+    self.monitor(sender);
+    self.set_mailbox_limit(mailbox_limit(2, overflow_drop_oldest));
+    send(self, sender, 3);
+
+    /// sender's exit is queued in the lane of its 10, behind it; taking 10
+    /// leaves the exit oldest there.
+    wait(self, boost::chrono::milliseconds(100));
+    recv(self, 10);
+    send(self, base_id, 1);
+
+    /// 11 is queued, 12 drops it, not the exit.
+    wait(self, boost::chrono::milliseconds(100));
+    message msg;
+    BOOST_ASSERT(self.recv(msg, match(exit, zero)) == sender);
+    BOOST_ASSERT(self.recv(msg, match(zero)));
+    BOOST_ASSERT(msg.get_type() == 12);
+    BOOST_ASSERT(!self.recv(msg, match(zero)));
+
+    send(self, base_id, 2);
+  }
+
+  static void test_drop_keeps_exit()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t aid =
+        spawn(base, boost::bind(&mailbox_limit_ut::exit_keep_actor, _1, base.get_aid()));
+      recv(base, 1);
+      base.send(aid, message(11));
+      base.send(aid, message(12));
+      recv(base, 2);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void test_block_response()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t aid =
+        spawn(base, boost::bind(&mailbox_limit_ut::block_actor, _1, base.get_aid()));
+      recv(base, 1);
+      for (match_t type=10; type<13; ++type)
+      {
+        base.send(aid, message(type));
+      }
+      recv(base, 2);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void test_block_cap()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      /// 10 queued, 11 held back, 12 past the cap is rejected.
+      std::vector<match_t> expect;
+      expect.push_back(10);
+      expect.push_back(11);
+      aid_t aid =
+        spawn(
+          base,
+          boost::bind(
+            &mailbox_limit_ut::limit_actor, _1,
+            base.get_aid(), overflow_block, expect, 1
+            )
+          );
+
+      recv(base, 1);
+      for (match_t type=10; type<13; ++type)
+      {
+        base.send(aid, message(type));
+      }
+
+      aid_t sender;
+      match_t type = match_nil;
+      recv(base, overflow, sender, type);
+      BOOST_ASSERT(sender == aid);
+      BOOST_ASSERT(type == 12);
+      recv(base, 2);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void test_threaded()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+      base.set_mailbox_limit(mailbox_limit(2, overflow_drop_newest));
+
+      aid_t aid =
+        spawn(base, boost::bind(&mailbox_limit_ut::burst_actor, _1, base.get_aid()));
+      send(base, aid, 1);
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+
+      message msg;
+      BOOST_ASSERT(base.recv(msg, match(seconds_t(1))));
+      BOOST_ASSERT(msg.get_type() == 10);
+      BOOST_ASSERT(base.recv(msg, match(seconds_t(1))));
+      BOOST_ASSERT(msg.get_type() == 11);
+      BOOST_ASSERT(!base.recv(msg, match(zero)));
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void test_policy(
+    overflow_policy policy, match_t t1, match_t t2, match_t t3 = match_nil
+    )
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      std::vector<match_t> expect;
+      expect.push_back(t1);
+      expect.push_back(t2);
+      if (t3 != match_nil)
+      {
+        expect.push_back(t3);
+      }
+
+      aid_t aid =
+        spawn(
+          base,
+          boost::bind(
+            &mailbox_limit_ut::limit_actor, _1,
+            base.get_aid(), policy, expect, 2
+            )
+          );
+
+      recv(base, 1);
+      for (match_t type=10; type<13; ++type)
+      {
+        base.send(aid, message(type));
+      }
+
+      aid_t sender;
+      boost::uint64_t size = 0;
+      recv(base, overload, sender, size);
+      BOOST_ASSERT(sender == aid);
+      BOOST_ASSERT(size == 2);
+
+      if (policy == overflow_reject)
+      {
+        match_t type = match_nil;
+        recv(base, overflow, sender, type);
+        BOOST_ASSERT(sender == aid);
+        BOOST_ASSERT(type == 12);
+
+        /// A rejected request fails instead of timing out.
+        response_t res = request(base, aid, 13);
+        bool thrown = false;
+        try
+        {
+          recv(base, res);
+        }
+        catch (std::runtime_error&)
+        {
+          thrown = true;
+        }
+        BOOST_ASSERT(thrown);
+      }
+
+      recv(base, 2);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+};
+}
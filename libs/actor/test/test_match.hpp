@@ -16,6 +16,15 @@ public:
   {
     std::cout << "match_ut begin." << std::endl;
     test_common();
+    test_priority();
+    test_exit_order();
+    test_many_types(attributes().match_index_size_);
+    test_many_types(4);
+    test_full_index();
+    test_match_of();
+    test_select();
+    test_batch();
+    test_stackless_batch();
     std::cout << "match_ut end." << std::endl;
   }
 
@@ -86,6 +95,486 @@ public:
       std::cerr << ex.what() << std::endl;
     }
   }
+
+  static void prio_actor(actor<stackful>& self, aid_t base_id)
+  {
+    /// Let all msgs arrive first.
+    wait(self, boost::chrono::milliseconds(100));
+
+    message msg;
+    self.recv(msg);
+    BOOST_ASSERT(msg.get_type() == 3);
+    BOOST_ASSERT(msg.get_priority() == prio_urgent);
+
+    /// Selective recv sees urgent msgs of a type first, too.
+    match mach;
+    mach.match_list_.push_back(2);
+    self.recv(msg, mach);
+    BOOST_ASSERT(msg.get_priority() == prio_urgent);
+    self.recv(msg, mach);
+    BOOST_ASSERT(msg.get_priority() == prio_normal);
+
+    self.recv(msg);
+    BOOST_ASSERT(msg.get_type() == 1);
+    send(self, base_id, 1);
+  }
+
+  static void result_actor(actor<stackful>& self, aid_t recver)
+  {
+    send(self, recver, 5);
+  }
+
+  static void exit_order_actor(actor<stackful>& self, aid_t base_id)
+  {
+    spawn(
+      self,
+      boost::bind(&match_ut::result_actor, _1, self.get_aid()),
+      linked
+      );
+
+    /// Let the result and the exit arrive first.
+    wait(self, boost::chrono::milliseconds(100));
+
+    /// A linked actor's exit comes after msgs it sent before it.
+    message msg;
+    self.recv(msg);
+    BOOST_ASSERT(msg.get_type() == 5);
+    self.recv(msg);
+    BOOST_ASSERT(msg.get_type() == exit);
+    send(self, base_id, 1);
+  }
+
+  static void many_types_actor(
+    actor<stackful>& self, aid_t base_id, std::size_t type_num
+    )
+  {
+    /// Let all msgs arrive first.
+    wait(self, boost::chrono::milliseconds(100));
+
+    /// A type never sent, looked up against a (maybe) full index.
+    message msg;
+    match unseen(zero);
+    unseen.match_list_.push_back(999);
+    BOOST_ASSERT(!self.recv(msg, unseen));
+
+    /// Two msgs of every type, recv'ed from the last type to the first.
+    for (std::size_t i=type_num; i>0; --i)
+    {
+      match_t type = 1000 + i - 1;
+      for (int n=0; n<2; ++n)
+      {
+        int k = -1;
+        recv(self, type, k);
+        BOOST_ASSERT(k == n);
+      }
+    }
+
+    BOOST_ASSERT(!self.recv(msg, match(zero)));
+    send(self, base_id, 1);
+  }
+
+  static void test_many_types(std::size_t match_index_size)
+  {
+    try
+    {
+      std::size_t type_num = 64;
+      attributes attrs;
+      attrs.match_index_size_ = match_index_size;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t aid =
+        spawn(
+          base,
+          boost::bind(
+            &match_ut::many_types_actor, _1,
+            base.get_aid(), type_num
+            )
+          );
+
+      for (int n=0; n<2; ++n)
+      {
+        for (std::size_t i=0; i<type_num; ++i)
+        {
+          send(base, aid, 1000 + i, n);
+        }
+      }
+
+      recv(base, 1);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void test_full_index()
+  {
+    try
+    {
+      detail::match_index index(4);
+      std::vector<std::size_t> id_list;
+      for (match_t type=1000; type<1064; ++type)
+      {
+        std::size_t id = index.get(type);
+        BOOST_ASSERT(id <= 4);
+        BOOST_ASSERT(id == 0 || std::find(id_list.begin(), id_list.end(), id) == id_list.end());
+        BOOST_ASSERT(index.find(type) == id);
+        id_list.push_back(id);
+      }
+
+      /// Lookups of unseen types neither insert nor hang on a full table.
+      for (match_t type=2000; type<2064; ++type)
+      {
+        BOOST_ASSERT(index.find(type) == 0);
+      }
+
+      for (match_t type=1000; type<1064; ++type)
+      {
+        BOOST_ASSERT(index.get(type) == id_list[type - 1000]);
+      }
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void match_of_actor(actor<stackful>& self, aid_t base_id)
+  {
+    /// Let all msgs arrive first.
+    wait(self, boost::chrono::milliseconds(100));
+
+    message msg;
+    self.recv(msg, match_of<4, 5>());
+    BOOST_ASSERT(msg.get_type() == 4);
+    self.recv(msg, match_of<4, 5>());
+    BOOST_ASSERT(msg.get_type() == 5);
+    BOOST_ASSERT(!self.recv(msg, match_of<4, 5, 7>(zero)));
+
+    /// More types than kept inline.
+    match mach(zero);
+    for (match_t type=10; type<30; ++type)
+    {
+      mach.match_list_.push_back(type);
+    }
+    mach.match_list_.push_back(6);
+    BOOST_ASSERT(self.recv(msg, mach));
+    BOOST_ASSERT(msg.get_type() == 6);
+
+    send(self, base_id, 1);
+  }
+
+  static void test_match_of()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t aid =
+        spawn(
+          base,
+          boost::bind(&match_ut::match_of_actor, _1, base.get_aid())
+          );
+
+      base.send(aid, message(5));
+      base.send(aid, message(6));
+      base.send(aid, message(4));
+
+      recv(base, 1);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void select_child(actor<stackful>& self, aid_t recver, int tag, match_t svc)
+  {
+    if (svc != match_nil)
+    {
+      register_service(self, svc);
+    }
+
+    message m(7);
+    m << tag;
+    self.send(recver, m);
+
+    /// Keep service registered until recver done.
+    recv(self, 2);
+    if (svc != match_nil)
+    {
+      deregister_service(self, svc);
+    }
+  }
+
+  static bool tag_is(aid_t, message const& msg, int tag)
+  {
+    message m(msg);
+    int i;
+    m >> i;
+    return i == tag;
+  }
+
+  static int get_tag(message& msg)
+  {
+    int i;
+    msg >> i;
+    return i;
+  }
+
+  static void select_actor(actor<stackful>& self, aid_t base_id)
+  {
+    aid_t a = spawn(self, boost::bind(&match_ut::select_child, _1, self.get_aid(), 1, match_nil));
+    aid_t b = spawn(self, boost::bind(&match_ut::select_child, _1, self.get_aid(), 2, match_nil));
+    aid_t c = spawn(self, boost::bind(&match_ut::select_child, _1, self.get_aid(), 3, atom("sel_svc")));
+
+    /// Let all msgs arrive first.
+    wait(self, boost::chrono::milliseconds(100));
+
+    message msg;
+    match mach(7, zero);
+    mach.from_ = b;
+    BOOST_ASSERT(self.recv(msg, mach) == b);
+    BOOST_ASSERT(get_tag(msg) == 2);
+    BOOST_ASSERT(!self.recv(msg, mach));
+
+    mach.from_ = aid_t();
+    mach.svc_ = svcid_t(atom("sel_svc"));
+    BOOST_ASSERT(self.recv(msg, mach) == c);
+    BOOST_ASSERT(get_tag(msg) == 3);
+    BOOST_ASSERT(!self.recv(msg, mach));
+
+    mach.svc_ = svcid_t();
+    mach.pred_ = boost::bind(&match_ut::tag_is, _1, _2, 5);
+    BOOST_ASSERT(!self.recv(msg, mach));
+    mach.pred_ = boost::bind(&match_ut::tag_is, _1, _2, 1);
+    BOOST_ASSERT(self.recv(msg, mach) == a);
+    BOOST_ASSERT(get_tag(msg) == 1);
+
+    self.send(a, message(2));
+    self.send(b, message(2));
+    self.send(c, message(2));
+    send(self, base_id, 1);
+  }
+
+  static void test_select()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      spawn(
+        base,
+        boost::bind(&match_ut::select_actor, _1, base.get_aid())
+        );
+
+      recv(base, 1);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void batch_actor(actor<stackful>& self, aid_t base_id)
+  {
+    recv(self, 3);
+
+    msg_batch_t batch;
+    BOOST_ASSERT(recv_batch(self, batch, 4, match(1)) == 4);
+    BOOST_ASSERT(recv_batch(self, batch, 10, match(1)) == 1);
+    BOOST_ASSERT(batch.size() == 5);
+    for (std::size_t i=0; i<batch.size(); ++i)
+    {
+      int i_;
+      batch[i].second >> i_;
+      BOOST_ASSERT(batch[i].first == base_id);
+      BOOST_ASSERT(i_ == (int)i);
+    }
+
+    batch.clear();
+    BOOST_ASSERT(recv_batch(self, batch, 10, match(2)) == 3);
+    BOOST_ASSERT(self.recv_batch(batch, 10, match(1, zero)) == 0);
+    BOOST_ASSERT(batch.size() == 3);
+
+    /// Nothing there yet, wait for base's next msg.
+    batch.clear();
+    send(self, base_id, 3);
+    BOOST_ASSERT(recv_batch(self, batch, 10, match(1)) == 1);
+
+    for (std::size_t i=0; i<3; ++i)
+    {
+      send(self, base_id, 4);
+    }
+    send(self, base_id, 5);
+  }
+
+  static void test_batch()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t aid = spawn(
+        base,
+        boost::bind(&match_ut::batch_actor, _1, base.get_aid())
+        );
+
+      for (int i=0; i<5; ++i)
+      {
+        send(base, aid, 1, i);
+        if (i < 3)
+        {
+          send(base, aid, 2);
+        }
+      }
+      send(base, aid, 3);
+
+      recv(base, 3);
+      wait(base, boost::chrono::milliseconds(10));
+      send(base, aid, 1);
+
+      msg_batch_t batch;
+      BOOST_ASSERT(recv_batch(base, batch, 10, match(5)) == 1);
+      BOOST_ASSERT(recv_batch(base, batch, 10, match(4)) == 3);
+      BOOST_ASSERT(batch.size() == 4);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void batch_target(actor<stackful>& self)
+  {
+    recv(self, 2);
+  }
+
+  class stackless_batch
+    : public boost::enable_shared_from_this<stackless_batch>
+  {
+  public:
+    stackless_batch(aid_t target, aid_t base_id)
+      : target_(target)
+      , base_id_(base_id)
+    {
+    }
+
+    void run(actor<stackless>& self)
+    {
+      GCE_REENTER (self)
+      {
+        self.link(target_);
+        send(self, base_id_, 3);
+        GCE_YIELD recv_batch(self, batch_, 10, match(1));
+        BOOST_ASSERT(batch_.size() == 1);
+
+        /// target's exit must stop self, not come back in batch_.
+        batch_.clear();
+        send(self, base_id_, 4);
+        GCE_YIELD recv_batch(self, batch_, 10, match(1));
+        send(self, base_id_, 5);
+      }
+    }
+
+  private:
+    aid_t target_;
+    aid_t base_id_;
+    msg_batch_t batch_;
+  };
+
+  static void test_stackless_batch()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t target = spawn(base, boost::bind(&match_ut::batch_target, _1));
+      aid_t aid = spawn<stackless>(
+        base,
+        boost::bind(
+          &stackless_batch::run,
+          boost::make_shared<stackless_batch>(target, base.get_aid()), _1
+          ),
+        monitored
+        );
+
+      recv(base, 3);
+      send(base, aid, 1);
+      recv(base, 4);
+      send(base, target, 2);
+
+      message msg;
+      BOOST_ASSERT(base.recv(msg, match(exit)) == aid);
+      BOOST_ASSERT(!base.recv(msg, match(5, zero)));
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void test_priority()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t aid =
+        spawn(
+          base,
+          boost::bind(&match_ut::prio_actor, _1, base.get_aid())
+          );
+
+      base.send(aid, message(1));
+      base.send(aid, message(2));
+
+      message m3(3);
+      m3.set_priority(prio_urgent);
+      base.send(aid, m3);
+
+      message m2(2);
+      m2.set_priority(prio_urgent);
+      base.send(aid, m2);
+
+      recv(base, 1);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void test_exit_order()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      spawn(
+        base,
+        boost::bind(&match_ut::exit_order_actor, _1, base.get_aid())
+        );
+      recv(base, 1);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
 };
 }
 
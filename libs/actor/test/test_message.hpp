@@ -11,6 +11,7 @@
 #include <boost/thread.hpp>
 #include <boost/assign.hpp>
 #include <sstream>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <map>
@@ -46,6 +47,10 @@ public:
     {
       test_common();
     }
+    test_typed();
+    test_move();
+    test_pool();
+    test_cow();
     std::cout << "message_ut end." << std::endl;
   }
 
@@ -113,6 +118,263 @@ public:
     thrs.join_all();
   }
 
+  static void typed_actor(actor<stackful>& self)
+  {
+    arg2_t arg2;
+    aid_t sender = recv(self, atom("typed"), arg2);
+    BOOST_ASSERT(arg2.v_.size() == 3 && arg2.v_[2] == 3 && arg2.i_ == 42);
+    arg2.i_ = 43;
+    reply_typed(self, sender, atom("ret"), arg2);
+  }
+
+  static void test_typed()
+  {
+    try
+    {
+      arg2_t arg2;
+      arg2.v_.push_back(1);
+      arg2.v_.push_back(2);
+      arg2.v_.push_back(3);
+      arg2.i_ = 42;
+
+      message m(atom("typed"));
+      m.set_object(arg2);
+      BOOST_ASSERT(m.size() == 0);
+      BOOST_ASSERT(!m.get_object<arg1_t>());
+
+      /// Copies share the object, no encoding.
+      message cp(m);
+      BOOST_ASSERT(cp.get_object<arg2_t>() == m.get_object<arg2_t>());
+
+      arg2_t out;
+      cp >> out;
+      BOOST_ASSERT(out.v_ == arg2.v_ && out.i_ == 42);
+
+      /// Read once, then it is past the end, like its bytes would be.
+      bool overflow = false;
+      try
+      {
+        int i = 0;
+        cp >> i;
+      }
+      catch (std::runtime_error&)
+      {
+        overflow = true;
+      }
+      BOOST_ASSERT(overflow);
+
+      /// Leaving the process (here, nested) serializes it.
+      message outer;
+      outer << m;
+      message inner;
+      outer >> inner;
+      BOOST_ASSERT(!inner.has_object() && inner.size() > 0);
+      arg2_t dec;
+      inner >> dec;
+      BOOST_ASSERT(dec.v_ == arg2.v_ && dec.i_ == 42);
+      BOOST_ASSERT(m.has_object());
+
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+      aid_t aid = spawn(base, boost::bind(&message_ut::typed_actor, _1));
+      response_t res = request_typed(base, aid, atom("typed"), arg2);
+      message ret;
+      base.recv(res, ret);
+      BOOST_ASSERT(ret.get_object<arg2_t>());
+      ret >> out;
+      BOOST_ASSERT(out.i_ == 43);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_typed except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void move_actor(actor<stackful>& self)
+  {
+    message m;
+    aid_t sender = self.recv(m);
+    self.send(sender, boost::move(m));
+  }
+
+  static void test_move()
+  {
+    try
+    {
+      message m(atom("move"));
+      for (std::size_t i=0; i<10; ++i)
+      {
+        add_arg(m);
+      }
+      BOOST_ASSERT(!m.is_small());
+      std::size_t size = m.size();
+
+      message cp(m);
+      message mv(boost::move(m));
+      BOOST_ASSERT(mv.get_type() == atom("move") && mv.size() == size);
+      BOOST_ASSERT(std::memcmp(mv.data(), cp.data(), size) == 0);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+      /// Moved from, left empty and reusable.
+      BOOST_ASSERT(m.size() == 0 && m.is_small());
+      m << size;
+      BOOST_ASSERT(m.size() > 0);
+#endif
+
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+      aid_t aid = spawn(base, boost::bind(&message_ut::move_actor, _1));
+      base.send(aid, mv);
+
+      message ret;
+      base.recv(ret);
+      BOOST_ASSERT(ret.get_type() == atom("move") && ret.size() == size);
+      BOOST_ASSERT(std::memcmp(ret.data(), cp.data(), size) == 0);
+      arg1_t arg1;
+      arg2_t arg2;
+      ret >> arg1 >> arg2;
+      BOOST_ASSERT(arg1.i_ == 1 && arg2.i_ == 2);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_move except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void make_msgs(std::vector<message>& msgs)
+  {
+    for (std::size_t i=0; i<200; ++i)
+    {
+      std::vector<byte_t> bytes(GCE_SMALL_MSG_SIZE + i * 97, (byte_t)i);
+      msgs.push_back(message(&bytes[0], bytes.size()));
+    }
+  }
+
+  static void check_msgs(std::vector<message>& msgs)
+  {
+    for (std::size_t i=0; i<msgs.size(); ++i)
+    {
+      message const& m = msgs[i];
+      BOOST_ASSERT(m.size() == GCE_SMALL_MSG_SIZE + i * 97);
+      BOOST_ASSERT(m.data()[0] == (byte_t)i && m.data()[m.size() - 1] == (byte_t)i);
+    }
+    msgs.clear();
+  }
+
+  static void copy_msgs(std::vector<message> const& msgs)
+  {
+    for (std::size_t n=0; n<20; ++n)
+    {
+      std::vector<message> cps(msgs);
+      check_msgs(cps);
+    }
+  }
+
+  static void test_pool()
+  {
+    try
+    {
+      for (std::size_t n=0; n<10; ++n)
+      {
+        /// Made here, freed on another thread.
+        std::vector<message> msgs;
+        make_msgs(msgs);
+        boost::thread thr(boost::bind(&message_ut::check_msgs, boost::ref(msgs)));
+        thr.join();
+
+        /// Made on a thread that exits before they are freed.
+        boost::thread thr2(boost::bind(&message_ut::make_msgs, boost::ref(msgs)));
+        thr2.join();
+        check_msgs(msgs);
+
+        /// Copied and dropped on many threads while the maker holds them.
+        make_msgs(msgs);
+        boost::thread_group thrs;
+        for (std::size_t i=0; i<4; ++i)
+        {
+          thrs.create_thread(boost::bind(&message_ut::copy_msgs, boost::cref(msgs)));
+        }
+        std::vector<message> cps(msgs);
+        thrs.join_all();
+        check_msgs(msgs);
+        check_msgs(cps);
+      }
+
+      /// Grows while streaming in.
+      message m;
+      std::string str(5000, 'x');
+      for (std::size_t i=0; i<50; ++i)
+      {
+        m << str;
+      }
+      for (std::size_t i=0; i<50; ++i)
+      {
+        std::string out;
+        m >> out;
+        BOOST_ASSERT(out == str);
+      }
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_pool except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void append_moved(message& m, bool shared)
+  {
+    message mv(boost::move(m));
+    byte_t const* data = mv.data();
+    std::size_t size = mv.size();
+    mv << size;
+    BOOST_ASSERT(mv.size() > size);
+
+    /// Off the maker's thread, an unshared buffer is written in place.
+    BOOST_ASSERT((mv.data() == data) != shared);
+  }
+
+  static void cow_on_biased(bool shared)
+  {
+    /// Made on a biased thread, like a context's worker thread.
+    detail::buffer_pool::bias();
+    std::vector<byte_t> bytes(GCE_SMALL_MSG_SIZE * 4, 1);
+    message m(&bytes[0], bytes.size());
+    message cp;
+    if (shared)
+    {
+      cp = m;
+    }
+
+    boost::thread thr(
+      boost::bind(&message_ut::append_moved, boost::ref(m), shared)
+      );
+    thr.join();
+    if (shared)
+    {
+      BOOST_ASSERT(cp.size() == bytes.size());
+      BOOST_ASSERT(std::memcmp(cp.data(), &bytes[0], bytes.size()) == 0);
+    }
+  }
+
+  static void test_cow()
+  {
+    try
+    {
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+      /// Only a real move hands the buffer over unshared.
+      boost::thread thr(boost::bind(&message_ut::cow_on_biased, false));
+      thr.join();
+#endif
+
+      boost::thread thr2(boost::bind(&message_ut::cow_on_biased, true));
+      thr2.join();
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_cow except: " << ex.what() << std::endl;
+    }
+  }
+
   static void test_common()
   {
     try
@@ -0,0 +1,128 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+namespace gce
+{
+class offload_ut
+{
+public:
+  static void run()
+  {
+    std::cout << "offload_ut begin." << std::endl;
+    test_common();
+    std::cout << "offload_ut end." << std::endl;
+  }
+
+private:
+  static void blocking_call(int& ret)
+  {
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+    ret = 42;
+  }
+
+  static void blocking_throw()
+  {
+    throw std::runtime_error("blocking error");
+  }
+
+  static void stackful_actor(actor<stackful>& self, aid_t base_id)
+  {
+    int ret = 0;
+    offload(self, boost::bind(&offload_ut::blocking_call, boost::ref(ret)));
+    BOOST_ASSERT(ret == 42);
+
+    bool thrown = false;
+    try
+    {
+      offload(self, boost::bind(&offload_ut::blocking_throw));
+    }
+    catch (std::runtime_error&)
+    {
+      thrown = true;
+    }
+    BOOST_ASSERT(thrown);
+
+    send(self, base_id, atom("done"), ret);
+  }
+
+  class stackless_actor
+    : public boost::enable_shared_from_this<stackless_actor>
+  {
+  public:
+    explicit stackless_actor(aid_t base_id)
+      : base_id_(base_id)
+      , ret_(0)
+    {
+    }
+
+    void run(actor<stackless>& self)
+    {
+      GCE_REENTER (self)
+      {
+        GCE_YIELD offload(
+          self,
+          boost::bind(&offload_ut::blocking_call, boost::ref(ret_))
+          );
+        send(self, base_id_, atom("done"), ret_);
+      }
+    }
+
+  private:
+    aid_t base_id_;
+    int ret_;
+  };
+
+  static void echo(actor<stackful>& self)
+  {
+    message msg;
+    aid_t sender = self.recv(msg);
+    self.send(sender, msg);
+  }
+
+  static void test_common()
+  {
+    try
+    {
+      attributes attrs;
+      attrs.thread_num_ = 1;
+      attrs.per_thread_cache_pool_num_ = 1;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+      aid_t base_id = base.get_aid();
+
+      spawn(base, boost::bind(&offload_ut::stackful_actor, _1, base_id));
+      spawn<stackless>(
+        base,
+        boost::bind(
+          &stackless_actor::run,
+          boost::make_shared<stackless_actor>(base_id), _1
+          )
+        );
+
+      /// Both blocking calls in progress, the only strand must stay free.
+      aid_t echo_aid = spawn(base, boost::bind(&offload_ut::echo, _1));
+      send(base, echo_aid, atom("echo"));
+      message msg;
+      base.recv(msg);
+      BOOST_ASSERT(msg.get_type() == atom("echo"));
+
+      for (std::size_t i=0; i<2; ++i)
+      {
+        int ret = 0;
+        recv(base, atom("done"), ret);
+        BOOST_ASSERT(ret == 42);
+      }
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+};
+}
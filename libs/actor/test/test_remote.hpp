@@ -26,6 +26,7 @@ public:
   {
     std::cout << "remote_ut begin." << std::endl;
     test_base();
+    test_priority();
     std::cout << "remote_ut end." << std::endl;
   }
 
@@ -88,6 +89,67 @@ public:
     }
   }
 
+  /// Lanes served in order, each lane in its sending order.
+  static void prio_target(actor<stackful>& self)
+  {
+    /// Let all msgs arrive first.
+    wait(self, boost::chrono::milliseconds(200));
+
+    match_t const expect[] = {11, 12, 13, 1, 2, 3};
+    aid_t sender;
+    message msg;
+    BOOST_FOREACH(match_t type, expect)
+    {
+      sender = self.recv(msg, match(seconds_t(1)));
+      BOOST_ASSERT(sender);
+      BOOST_ASSERT(msg.get_type() == type);
+      BOOST_ASSERT(msg.get_priority() == (type > 10 ? prio_urgent : prio_normal));
+    }
+    send(self, sender, atom("done"));
+  }
+
+  static void test_priority()
+  {
+    try
+    {
+      attributes attrs;
+      attrs.id_ = atom("server");
+      context ctx_svr(attrs);
+      attrs.id_ = atom("client");
+      context ctx_cln(attrs);
+
+      actor<threaded> base_cln = spawn(ctx_cln);
+      actor<threaded> base_svr = spawn(ctx_svr);
+
+      remote_func_list_t func_list;
+      func_list.push_back(
+        std::make_pair(
+          atom("prio_target"),
+          make_actor_func<stackful>(
+            boost::bind(&remote_ut::prio_target, _1)
+            )
+          )
+        );
+      gce::bind(base_cln, "tcp://127.0.0.1:14923", false, func_list);
+      connect(base_svr, atom("client"), "tcp://127.0.0.1:14923");
+
+      aid_t target = spawn(base_svr, atom("prio_target"), atom("client"));
+      for (match_t type=1; type<4; ++type)
+      {
+        base_svr.send(target, message(type));
+
+        message m(type + 10);
+        m.set_priority(prio_urgent);
+        base_svr.send(target, m);
+      }
+      recv(base_svr, atom("done"));
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_priority except: " << ex.what() << std::endl;
+    }
+  }
+
   static void echo_server(actor<stackful>& self, std::size_t client_num)
   {
     try
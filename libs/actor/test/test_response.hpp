@@ -16,6 +16,11 @@ public:
   {
     std::cout << "response_ut begin." << std::endl;
     test_common();
+    test_deadline(false);
+    test_deadline(true);
+    test_deadline_replied();
+    test_gather();
+    test_discard();
     std::cout << "response_ut end." << std::endl;
   }
 
@@ -129,5 +134,289 @@ private:
       std::cerr << ex.what() << std::endl;
     }
   }
+
+  static void slow_actor(actor<stackful>& self)
+  {
+    /// Let both requests arrive, and the first one expire.
+    wait(self, boost::chrono::milliseconds(200));
+
+    message msg;
+    aid_t sender = self.recv(msg, match(zero));
+    BOOST_ASSERT(sender);
+    BOOST_ASSERT(msg.get_type() == atom("live"));
+    reply(self, sender, atom("ret"));
+    BOOST_ASSERT(!self.recv(msg, match(zero)));
+  }
+
+  static void early_reply_actor(actor<stackful>& self)
+  {
+    wait(self, boost::chrono::milliseconds(200));
+
+    /// Consumes the wait entry of sender's still queued, expired request.
+    aid_t sender = recv(self, atom("go"));
+    reply(self, sender, atom("ret"));
+
+    message msg;
+    BOOST_ASSERT(!self.recv(msg, match(zero)));
+    send(self, sender, atom("done"));
+  }
+
+  static std::size_t get_shed_num(context& ctx)
+  {
+    std::size_t shed_num = 0;
+    BOOST_FOREACH(fairness_stat const& stat, ctx.get_fairness_stat())
+    {
+      shed_num += stat.shed_num_;
+    }
+    return shed_num;
+  }
+
+  static void gather_child(actor<stackful>& self, std::size_t serve_num)
+  {
+    for (std::size_t i=0; i<serve_num; ++i)
+    {
+      aid_t sender = recv(self, atom("get"));
+      reply(self, sender, atom("ret"));
+    }
+  }
+
+  static void mute_actor(actor<stackful>& self)
+  {
+    recv(self, atom("stop"));
+  }
+
+  static void gather_actor(
+    actor<stackful>& self, std::vector<aid_t> kids, aid_t mute, aid_t base_id
+    )
+  {
+    res_batch_t batch;
+    BOOST_ASSERT(request_all(self, kids, message(atom("get")), batch) == kids.size());
+    BOOST_FOREACH(res_batch_t::value_type& pr, batch)
+    {
+      BOOST_ASSERT(pr.second.get_type() == atom("ret"));
+    }
+
+    batch.clear();
+    std::vector<aid_t> any_list;
+    any_list.push_back(mute);
+    any_list.push_back(kids.front());
+    BOOST_ASSERT(request_any(self, any_list, message(atom("get")), batch) == 1);
+    BOOST_ASSERT(batch.front().first.get_aid() == kids.front());
+
+    batch.clear();
+    response_list_t pending;
+    pending.push_back(request(self, mute, atom("get")));
+    BOOST_ASSERT(recv_all(self, pending, batch, boost::chrono::milliseconds(50)) == 0);
+    BOOST_ASSERT(pending.size() == 1);
+
+    send(self, base_id, atom("done"));
+  }
+
+  static void slow_child(actor<stackful>& self, std::size_t serve_num)
+  {
+    for (std::size_t i=0; i<serve_num; ++i)
+    {
+      aid_t sender = recv(self, atom("get"));
+      wait(self, boost::chrono::milliseconds(10));
+      reply(self, sender, atom("ret"));
+    }
+  }
+
+  static void any_actor(
+    actor<stackful>& self, aid_t fast, aid_t slow,
+    std::size_t round_num, aid_t base_id
+    )
+  {
+    message msg;
+    response_t first = request(self, fast, atom("get"));
+    BOOST_ASSERT(self.recv(first, msg));
+
+    std::vector<aid_t> any_list;
+    any_list.push_back(fast);
+    any_list.push_back(slow);
+    res_batch_t batch;
+    for (std::size_t i=0; i<round_num; ++i)
+    {
+      batch.clear();
+      BOOST_ASSERT(request_any(self, any_list, message(atom("get")), batch) >= 1);
+    }
+
+    /// Let the late answers arrive, none of them may be kept.
+    wait(self, boost::chrono::milliseconds(10 * round_num + 100));
+    for (sid_t id=first.get_id()+1; id<=first.get_id()+2*round_num; ++id)
+    {
+      BOOST_ASSERT(!self.recv(response_t(id, self.get_aid()), msg, zero));
+    }
+
+    send(self, base_id, atom("done"));
+  }
+
+  static void test_discard()
+  {
+    try
+    {
+      std::size_t round_num = 10;
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t fast =
+        spawn(base, boost::bind(&response_ut::gather_child, _1, round_num + 1));
+      aid_t slow =
+        spawn(base, boost::bind(&response_ut::slow_child, _1, round_num));
+      spawn(
+        base,
+        boost::bind(
+          &response_ut::any_actor, _1, fast, slow, round_num, base.get_aid()
+          )
+        );
+      recv(base, atom("done"));
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_discard except: " << ex.what() << std::endl;
+    }
+  }
+
+  class stackless_gather
+    : public boost::enable_shared_from_this<stackless_gather>
+  {
+  public:
+    stackless_gather(std::vector<aid_t> const& kids, aid_t base_id)
+      : kids_(kids)
+      , base_id_(base_id)
+    {
+    }
+
+    void run(actor<stackless>& self)
+    {
+      GCE_REENTER (self)
+      {
+        GCE_YIELD request_all(self, kids_, message(atom("get")), pending_, batch_);
+        BOOST_ASSERT(pending_.empty());
+        BOOST_ASSERT(batch_.size() == kids_.size());
+        send(self, base_id_, atom("done"));
+      }
+    }
+
+  private:
+    std::vector<aid_t> kids_;
+    aid_t base_id_;
+    response_list_t pending_;
+    res_batch_t batch_;
+  };
+
+  static void test_gather()
+  {
+    try
+    {
+      std::size_t kid_num = 5;
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      std::vector<aid_t> kids;
+      for (std::size_t i=0; i<kid_num; ++i)
+      {
+        /// First kid also answers gather_actor's request_any.
+        std::size_t serve_num = i == 0 ? 4 : 3;
+        kids.push_back(
+          spawn(base, boost::bind(&response_ut::gather_child, _1, serve_num))
+          );
+      }
+      aid_t mute = spawn(base, boost::bind(&response_ut::mute_actor, _1));
+
+      spawn(
+        base,
+        boost::bind(
+          &response_ut::gather_actor, _1, kids, mute, base.get_aid()
+          )
+        );
+      recv(base, atom("done"));
+
+      spawn<stackless>(
+        base,
+        boost::bind(
+          &stackless_gather::run,
+          boost::make_shared<stackless_gather>(kids, base.get_aid()), _1
+          )
+        );
+      recv(base, atom("done"));
+
+      res_batch_t batch;
+      BOOST_ASSERT(request_all(base, kids, message(atom("get")), batch) == kid_num);
+      send(base, mute, atom("stop"));
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_gather except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void test_deadline(bool is_remote)
+  {
+    try
+    {
+      attributes attrs;
+      attrs.id_ = atom("server");
+      context ctx_svr(attrs);
+      attrs.id_ = atom("client");
+      context ctx_cln(attrs);
+
+      actor<threaded> base = spawn(ctx_svr);
+      aid_t slow;
+      if (is_remote)
+      {
+        actor<threaded> base_cln = spawn(ctx_cln);
+        remote_func_list_t func_list;
+        func_list.push_back(
+          std::make_pair(
+            atom("slow_actor"),
+            make_actor_func<stackful>(
+              boost::bind(&response_ut::slow_actor, _1)
+              )
+            )
+          );
+        gce::bind(base_cln, "tcp://127.0.0.1:14933", false, func_list);
+        connect(base, atom("client"), "tcp://127.0.0.1:14933");
+        slow = spawn(base, atom("slow_actor"), atom("client"));
+      }
+      else
+      {
+        slow = spawn(base, boost::bind(&response_ut::slow_actor, _1));
+      }
+
+      request(base, slow, message(atom("stale")), boost::chrono::milliseconds(50));
+      response_t res = request(base, slow, atom("live"));
+      recv(base, res);
+
+      context& slow_ctx = is_remote ? ctx_cln : ctx_svr;
+      BOOST_ASSERT(get_shed_num(slow_ctx) == 1);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_deadline except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void test_deadline_replied()
+  {
+    try
+    {
+      attributes attrs;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t aid = spawn(base, boost::bind(&response_ut::early_reply_actor, _1));
+      request(base, aid, message(atom("stale")), boost::chrono::milliseconds(50));
+      send(base, aid, atom("go"));
+      recv(base, atom("done"));
+      BOOST_ASSERT(get_shed_num(ctx) == 1);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_deadline_replied except: " << ex.what() << std::endl;
+    }
+  }
 };
 }
@@ -0,0 +1,562 @@
+﻿///
+/// Copyright (c) 2009-2014 Nous Xiong (348944179 at qq dot com)
+///
+/// Distributed under the Boost Software License, Version 1.0. (See accompanying
+/// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+///
+/// See https://github.com/nousxiong/gce for latest version.
+///
+
+namespace gce
+{
+class sched_ut
+{
+public:
+  static void run()
+  {
+    std::cout << "sched_ut begin." << std::endl;
+    attributes attrs;
+    attrs.thread_num_ = 4;
+
+    attrs.sched_mode_ = sched_actor;
+    test_common(attrs);
+    test_socket(attrs, "tcp://127.0.0.1:14925");
+
+    attrs.sched_mode_ = sched_cache_pool;
+    attrs.per_thread_io_service_ = true;
+    test_common(attrs);
+    test_socket(attrs, "tcp://127.0.0.1:14926");
+
+    attrs.sched_mode_ = sched_actor;
+    test_common(attrs);
+    test_socket(attrs, "tcp://127.0.0.1:14927");
+
+    attrs.sched_mode_ = sched_cache_pool;
+    attrs.per_thread_io_service_ = false;
+    attrs.numa_policy_ = numa_local;
+    attrs.cpu_list_.push_back(0);
+    test_common(attrs);
+    test_socket(attrs, "tcp://127.0.0.1:14928");
+
+    attrs.placement_ = place_least_loaded;
+    test_common(attrs);
+    attrs.numa_policy_ = numa_none;
+    attrs.cpu_list_.clear();
+    test_common(attrs);
+    test_socket(attrs, "tcp://127.0.0.1:14929");
+
+    attrs.placement_ = place_round_robin;
+    attrs.thread_num_ = 1;
+    attrs.max_thread_num_ = 4;
+    attrs.elastic_period_ = boost::chrono::milliseconds(1);
+    test_common(attrs);
+    test_socket(attrs, "tcp://127.0.0.1:14930");
+
+    attrs.thread_num_ = 2;
+    attrs.spin_period_ = boost::chrono::microseconds(50);
+    test_common(attrs);
+    test_socket(attrs, "tcp://127.0.0.1:14931");
+
+    attrs.max_thread_num_ = 0;
+    attrs.spin_period_ = zero;
+    attrs.pool_list_.push_back(pool_attributes(atom("cpu"), 2));
+    attrs.io_pool_ = atom("io");
+    test_common(attrs);
+    test_socket(attrs, "tcp://127.0.0.1:14932");
+
+    test_numa();
+    test_named_pool();
+    test_budget();
+    test_elastic(zero);
+    test_elastic(boost::chrono::microseconds(50));
+    test_watchdog();
+    std::cout << "sched_ut end." << std::endl;
+  }
+
+private:
+  static void stackful_child(actor<stackful>& self)
+  {
+    aid_t aid = recv(self);
+    reply(self, aid);
+  }
+
+  class stackless_child
+    : public boost::enable_shared_from_this<stackless_child>
+  {
+  public:
+    void run(actor<stackless>& self)
+    {
+      GCE_REENTER (self)
+      {
+        GCE_YIELD recv(self, aid_);
+        reply(self, aid_);
+      }
+    }
+
+  private:
+    aid_t aid_;
+  };
+
+  static void my_actor(actor<stackful>& self, aid_t base_id)
+  {
+    std::size_t size = 20;
+    std::vector<response_t> res_list;
+    for (std::size_t i=0; i<size; ++i)
+    {
+      aid_t aid =
+        spawn(
+          self,
+          boost::bind(&sched_ut::stackful_child, _1)
+          );
+      res_list.push_back(request(self, aid));
+
+      aid =
+        spawn<stackless>(
+          self,
+          boost::bind(
+            &stackless_child::run,
+            boost::make_shared<stackless_child>(), _1
+            )
+          );
+      res_list.push_back(request(self, aid));
+    }
+
+    for (std::size_t i=0; i<res_list.size(); ++i)
+    {
+      aid_t aid;
+      message msg;
+      do
+      {
+        aid = self.recv(res_list[i], msg, seconds_t(1));
+      }
+      while (!aid);
+    }
+
+    send(self, base_id);
+  }
+
+  static void test_common(attributes attrs)
+  {
+    try
+    {
+      std::size_t my_actor_size = 20;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t base_id = base.get_aid();
+      for (std::size_t i=0; i<my_actor_size; ++i)
+      {
+        spawn(
+          base,
+          boost::bind(
+            &sched_ut::my_actor, _1,
+            base_id
+            )
+          );
+      }
+
+      for (std::size_t i=0; i<my_actor_size; ++i)
+      {
+        recv(base);
+      }
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  static void get_thread_id(
+    actor<stackful>& self, aid_t base_id, boost::thread::id& thr_id
+    )
+  {
+    thr_id = boost::this_thread::get_id();
+    send(self, base_id, atom("done"));
+  }
+
+  static void pool_actor(
+    actor<stackful>& self, aid_t base_id,
+    boost::thread::id& thr_id, boost::thread::id& child_thr_id
+    )
+  {
+    thr_id = boost::this_thread::get_id();
+    spawn(
+      self,
+      boost::bind(
+        &sched_ut::get_thread_id, _1,
+        self.get_aid(), boost::ref(child_thr_id)
+        ),
+      pool_name(atom("cpu"))
+      );
+    recv(self, atom("done"));
+    send(self, base_id, atom("done"));
+  }
+
+  static void test_numa()
+  {
+    try
+    {
+      attributes attrs;
+      attrs.thread_num_ = 4;
+      attrs.per_thread_cache_pool_num_ = 2;
+      attrs.numa_policy_ = numa_local;
+      attrs.cpu_list_.push_back(0);
+
+      {
+        context ctx(attrs);
+        std::vector<std::vector<std::size_t> > const& node_pool_list =
+          ctx.get_node_pool_list();
+        BOOST_ASSERT(!node_pool_list.empty());
+
+        /// Every default pool sits on exactly one node.
+        std::vector<bool> seen(attrs.thread_num_ * attrs.per_thread_cache_pool_num_, false);
+        BOOST_FOREACH(std::vector<std::size_t> const& pool_list, node_pool_list)
+        {
+          BOOST_FOREACH(std::size_t i, pool_list)
+          {
+            BOOST_ASSERT(i < seen.size() && !seen[i]);
+            seen[i] = true;
+          }
+        }
+        BOOST_ASSERT(std::find(seen.begin(), seen.end(), false) == seen.end());
+      }
+
+      attrs.numa_policy_ = numa_none;
+      context ctx(attrs);
+      BOOST_ASSERT(ctx.get_node_pool_list().empty());
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_numa except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void test_named_pool()
+  {
+    try
+    {
+      attributes attrs;
+      attrs.thread_num_ = 1;
+      attrs.pool_list_.push_back(pool_attributes(atom("cpu"), 2));
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+      aid_t base_id = base.get_aid();
+
+      boost::thread::id default_thr_id;
+      spawn(
+        base,
+        boost::bind(
+          &sched_ut::get_thread_id, _1,
+          base_id, boost::ref(default_thr_id)
+          )
+        );
+      recv(base, atom("done"));
+
+      boost::thread::id thr_id;
+      boost::thread::id child_thr_id;
+      spawn(
+        base,
+        boost::bind(
+          &sched_ut::pool_actor, _1, base_id,
+          boost::ref(thr_id), boost::ref(child_thr_id)
+          ),
+        pool_name(atom("cpu"))
+        );
+      recv(base, atom("done"));
+
+      BOOST_ASSERT(thr_id != boost::thread::id());
+      BOOST_ASSERT(thr_id != default_thr_id);
+      BOOST_ASSERT(child_thr_id != boost::thread::id());
+      BOOST_ASSERT(child_thr_id != default_thr_id);
+
+      bool not_found = false;
+      try
+      {
+        spawn(
+          base,
+          boost::bind(&sched_ut::stackful_child, _1),
+          pool_name(atom("none"))
+          );
+      }
+      catch (std::runtime_error&)
+      {
+        not_found = true;
+      }
+      BOOST_ASSERT(not_found);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_named_pool except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void burst_actor(actor<stackful>& self, aid_t target, std::size_t msg_num)
+  {
+    /// Post, not run, target's drain, so the msgs pile up in its inbox.
+    self.chain(false);
+    for (std::size_t i=0; i<msg_num; ++i)
+    {
+      send(self, target, atom("msg"));
+    }
+    send(self, target, atom("go"));
+  }
+
+  static void budget_actor(actor<stackful>& self, std::size_t msg_num)
+  {
+    /// Msgs drain into the mailbox while waiting for go, then are recv'ed
+    /// in a tight loop.
+    recv(self, atom("go"));
+    for (std::size_t i=0; i<msg_num; ++i)
+    {
+      message msg;
+      self.recv(msg);
+    }
+  }
+
+  static void test_budget()
+  {
+    try
+    {
+      std::size_t msg_num = 100;
+      attributes attrs;
+      attrs.thread_num_ = 1;
+      attrs.msg_budget_ = 4;
+      attrs.track_fairness_ = true;
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      aid_t aid =
+        spawn(
+          base,
+          boost::bind(&sched_ut::budget_actor, _1, msg_num),
+          monitored
+          );
+      spawn(base, boost::bind(&sched_ut::burst_actor, _1, aid, msg_num));
+      recv(base);
+
+      std::vector<fairness_stat> stat_list = ctx.get_fairness_stat();
+      std::size_t preempt_num = 0;
+      BOOST_FOREACH(fairness_stat const& stat, stat_list)
+      {
+        BOOST_ASSERT(stat.preempt_num_ <= stat.activation_num_);
+        preempt_num += stat.preempt_num_;
+      }
+      BOOST_ASSERT(preempt_num > 0);
+
+      /// Each msg counted once, when recv pops it, not again as it drained.
+      BOOST_ASSERT(preempt_num <= msg_num / attrs.msg_budget_ + 2);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_budget except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void on_thread_begin(thrid_t id, boost::atomic_size_t& max_id)
+  {
+    std::size_t curr = max_id;
+    while (id > curr && !max_id.compare_exchange_weak(curr, id))
+    {
+    }
+  }
+
+  static void on_thread_end(thrid_t, boost::atomic_size_t& end_num)
+  {
+    ++end_num;
+  }
+
+  /// Poll till num reaches least, with a generous deadline rather than
+  /// one fixed sleep; false if it never does.
+  static bool wait_until(boost::atomic_size_t const& num, std::size_t least)
+  {
+    boost::chrono::steady_clock::time_point deadline =
+      boost::chrono::steady_clock::now() + seconds_t(10);
+    while (num < least)
+    {
+      if (boost::chrono::steady_clock::now() >= deadline)
+      {
+        return false;
+      }
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  static void busy_actor(actor<stackful>& self)
+  {
+    aid_t sender = recv(self, atom("busy"));
+    boost::chrono::steady_clock::time_point end =
+      boost::chrono::steady_clock::now() + boost::chrono::milliseconds(5);
+    while (boost::chrono::steady_clock::now() < end)
+    {
+    }
+    send(self, sender, atom("done"));
+  }
+
+  static void test_elastic(duration_t spin_period)
+  {
+    try
+    {
+      boost::atomic_size_t max_id(0);
+      boost::atomic_size_t end_num(0);
+      attributes attrs;
+      attrs.thread_num_ = 1;
+      attrs.max_thread_num_ = 3;
+      attrs.elastic_period_ = boost::chrono::milliseconds(1);
+      attrs.spin_period_ = spin_period;
+      attrs.thread_begin_cb_list_.push_back(
+        boost::bind(&sched_ut::on_thread_begin, _1, boost::ref(max_id))
+        );
+      attrs.thread_end_cb_list_.push_back(
+        boost::bind(&sched_ut::on_thread_end, _1, boost::ref(end_num))
+        );
+
+      context ctx(attrs);
+      actor<threaded> base = spawn(ctx);
+
+      /// Load in rounds till an elastic thread starts.
+      boost::chrono::steady_clock::time_point deadline =
+        boost::chrono::steady_clock::now() + seconds_t(10);
+      while (max_id == 0 && boost::chrono::steady_clock::now() < deadline)
+      {
+        std::size_t busy_num = 20;
+        for (std::size_t i=0; i<busy_num; ++i)
+        {
+          aid_t aid = spawn(base, boost::bind(&sched_ut::busy_actor, _1));
+          send(base, aid, atom("busy"));
+        }
+
+        for (std::size_t i=0; i<busy_num; ++i)
+        {
+          recv(base, atom("done"));
+        }
+      }
+      BOOST_ASSERT(max_id > 0);
+
+      /// Then quiet, only elastic threads end before ctx does.
+      bool retired = wait_until(end_num, 1);
+      BOOST_ASSERT(retired);
+
+      /// Retired threads' slots are reused, so are their ids.
+      BOOST_ASSERT(max_id < attrs.max_thread_num_);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_elastic except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void slow_actor(actor<stackful>& self)
+  {
+    aid_t sender = recv(self, atom("slow"));
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+    send(self, sender, atom("done"));
+  }
+
+  static void on_stall(
+    aid_t, match_t type, duration_t,
+    boost::atomic_size_t& stall_num, match_t& stall_type
+    )
+  {
+    stall_type = type;
+    ++stall_num;
+  }
+
+  static void test_watchdog()
+  {
+    try
+    {
+      boost::atomic_size_t stall_num(0);
+      match_t stall_type = match_nil;
+      attributes attrs;
+      attrs.thread_num_ = 1;
+      attrs.stall_threshold_ = boost::chrono::milliseconds(20);
+      attrs.stall_cb_ =
+        boost::bind(
+          &sched_ut::on_stall, _1, _2, _3,
+          boost::ref(stall_num), boost::ref(stall_type)
+          );
+
+      {
+        context ctx(attrs);
+        actor<threaded> base = spawn(ctx);
+        aid_t aid = spawn(base, boost::bind(&sched_ut::slow_actor, _1));
+        send(base, aid, atom("slow"));
+        recv(base, atom("done"));
+
+        /// Reported by the watchdog thread or at the activation's end,
+        /// either may come after done.
+        bool reported = wait_until(stall_num, 1);
+        BOOST_ASSERT(reported);
+      }
+
+      BOOST_ASSERT(stall_num == 1);
+      BOOST_ASSERT(stall_type == atom("slow"));
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_watchdog except: " << ex.what() << std::endl;
+    }
+  }
+
+  static void echo(actor<stackful>& self)
+  {
+    while (true)
+    {
+      message msg;
+      aid_t sender = self.recv(msg);
+      if (msg.get_type() == atom("echo"))
+      {
+        self.send(sender, msg);
+      }
+      else
+      {
+        break;
+      }
+    }
+  }
+
+  static void test_socket(attributes attrs, std::string const& ep)
+  {
+    try
+    {
+      std::size_t echo_num = 100;
+
+      attrs.id_ = atom("one");
+      context ctx1(attrs);
+      attrs.id_ = atom("two");
+      context ctx2(attrs);
+
+      actor<threaded> base1 = spawn(ctx1);
+      actor<threaded> base2 = spawn(ctx2);
+
+      gce::bind(base2, ep);
+
+      aid_t echo_aid =
+        spawn(
+          base2,
+          boost::bind(&sched_ut::echo, _1),
+          monitored
+          );
+
+      net_option opt;
+      opt.reconn_period_ = seconds_t(1);
+      opt.busy_poll_ = attrs.spin_period_ > zero ? 50 : 0;
+      connect(base1, atom("two"), ep, false, opt);
+
+      for (std::size_t i=0; i<echo_num; ++i)
+      {
+        send(base1, echo_aid, atom("echo"));
+        recv(base1, atom("echo"));
+      }
+      send(base1, echo_aid, atom("end"));
+
+      recv(base2);
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << "test_socket except: " << ex.what() << std::endl;
+    }
+  }
+};
+}